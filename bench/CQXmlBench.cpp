@@ -0,0 +1,1208 @@
+// headless benchmark of CQXml parse and widget construction on generated documents
+//
+// usage: CQXmlBench [-reps <n>] [-scale <f>] [-mode <mode>] ... [-cold] [-o <file.json>]
+//                   [<scenario>|<comparison> ...]
+//
+// Each scenario size and mode is run in a child process (CQXmlBench -run ...) so the
+// reported peak RSS is for that load only (rssDeltaKb is peak less RSS before load).
+//
+// With -cold each rep is run in its own child process so the timed load is the first
+// of the process (no interned names, property plans or icons from earlier loads, except
+// template mode which loads its template first). The binary mode result is compared
+// against the tree and stream results (coldStart).
+//
+// Modes (default tree, -mode all for all):
+//   tree     : createWidgetsFromString with retained tag tree
+//   stream   : streaming build (parse time is included in build time)
+//   binary   : createWidgetsFromBinary of form compiled before timing
+//   template : cached template (timed load is a cache hit)
+//   arena    : arena allocated tags released after build
+//
+// Comparisons time the code removed by earlier changes against its replacement:
+//   ownerLookup     : tag owner by parent walk with dynamic_cast vs stored pointer
+//   propertySetters : per widget property lookup vs per class setter plans
+//   attributeStorage: per tag name map vs flat array of interned ids (time and
+//                     allocations per tag)
+//
+// runs with the offscreen platform unless QT_QPA_PLATFORM is already set
+
+#include <CQXml.h>
+
+#include <QApplication>
+#include <QWidget>
+#include <QPushButton>
+#include <QMetaProperty>
+#include <QProcess>
+#include <QImage>
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QHash>
+#include <QReadWriteLock>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <functional>
+#include <memory>
+#include <sstream>
+
+// count heap allocations made while building
+static std::atomic<long> s_numAllocs { 0 };
+
+void *operator new(std::size_t size) {
+  ++s_numAllocs;
+
+  void *p = std::malloc(size ? size : 1);
+
+  if (! p)
+    throw std::bad_alloc();
+
+  return p;
+}
+
+void *operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+//------
+
+namespace CQXmlBench {
+
+// generated document and options used to load it
+struct Document {
+  std::string xml;
+  int         numTags    { 0 };
+  bool        batchItems { false };
+};
+
+struct Generator {
+  std::string                  name;
+  std::string                  param;
+  std::function<Document(int)> generate;
+  std::vector<int>             sizes;
+};
+
+struct Scenario {
+  const Generator *generator { nullptr };
+  int              size      { 0 };
+  QString          mode;
+};
+
+struct Result {
+  std::string name;
+  std::string param;
+  QString     mode;
+  int         size         { 0 };
+  int         numTags      { 0 };
+  qint64      parseNSecs   { 0 };
+  qint64      buildNSecs   { 0 };
+  double      allocsPerTag { 0.0 };
+  long        baseRSSKb    { 0 }; // before load
+  long        peakRSSKb    { 0 }; // peak of child process running this scenario
+};
+
+QString iconDir;
+
+long peakRSS() {
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+
+  return usage.ru_maxrss; // kilobytes on Linux
+}
+
+long currentRSS() {
+  QFile file("/proc/self/statm");
+
+  if (! file.open(QIODevice::ReadOnly))
+    return 0;
+
+  auto fields = QString(file.readAll()).split(' ');
+
+  if (fields.length() < 2)
+    return 0;
+
+  return fields[1].toLong()*(sysconf(_SC_PAGESIZE)/1024);
+}
+
+// n labels in one layout
+Document labels(int n) {
+  Document doc;
+
+  std::ostringstream os;
+
+  os << "<qxml>\n<QVBoxLayout>\n";
+
+  for (int i = 0; i < n; ++i)
+    os << "<QLabel name=\"label" << i << "\">Label " << i << "</QLabel>\n";
+
+  os << "</QVBoxLayout>\n</qxml>\n";
+
+  doc.xml     = os.str();
+  doc.numTags = n + 2;
+
+  return doc;
+}
+
+// frames nested to depth n (tags deep in the tree look up their CQXml)
+Document depth(int n) {
+  Document doc;
+
+  std::ostringstream os;
+
+  os << "<qxml>\n";
+
+  for (int i = 0; i < n; ++i)
+    os << "<QFrame><QVBoxLayout>\n";
+
+  os << "<QLabel>Leaf</QLabel>\n";
+
+  for (int i = 0; i < n; ++i)
+    os << "</QVBoxLayout></QFrame>\n";
+
+  os << "</qxml>\n";
+
+  doc.xml     = os.str();
+  doc.numTags = 2*n + 2;
+
+  return doc;
+}
+
+// 200 widgets with n attributes each (properties and unknown names)
+Document attributes(int n) {
+  static const char *props[] = {
+    "toolTip=\"tip\"", "statusTip=\"status\"", "whatsThis=\"what\"", "enabled=\"true\"",
+    "minimumWidth=\"10\"", "fixedHeight=\"20\"", "checkable=\"true\"", "flat=\"false\"",
+    "autoDefault=\"false\"", "objectName=\"button\""
+  };
+
+  const int numProps   = int(sizeof(props)/sizeof(props[0]));
+  const int numWidgets = 200;
+
+  Document doc;
+
+  std::ostringstream os;
+
+  os << "<qxml>\n<QVBoxLayout>\n";
+
+  for (int i = 0; i < numWidgets; ++i) {
+    os << "<QPushButton";
+
+    for (int j = 0; j < n; ++j) {
+      if (j < numProps)
+        os << " " << props[j];
+      else
+        os << " attr" << j << "=\"" << j << "\"";
+    }
+
+    os << ">Button</QPushButton>\n";
+  }
+
+  os << "</QVBoxLayout>\n</qxml>\n";
+
+  doc.xml     = os.str();
+  doc.numTags = numWidgets + 2;
+
+  return doc;
+}
+
+// 500 buttons using n distinct icon files
+Document icons(int n) {
+  const int numWidgets = 500;
+
+  for (int i = 0; i < n; ++i) {
+    auto filename = QString("%1/icon%2.png").arg(iconDir).arg(i);
+
+    if (QFile::exists(filename))
+      continue;
+
+    QImage image(32, 32, QImage::Format_ARGB32);
+
+    image.fill(QColor::fromHsv((i*37) % 360, 200, 200));
+
+    image.save(filename);
+  }
+
+  Document doc;
+
+  std::ostringstream os;
+
+  os << "<qxml>\n<QVBoxLayout>\n";
+
+  for (int i = 0; i < numWidgets; ++i)
+    os << "<QPushButton icon=\"" << iconDir.toStdString() << "/icon" << (i % n) <<
+          ".png\">Button</QPushButton>\n";
+
+  os << "</QVBoxLayout>\n</qxml>\n";
+
+  doc.xml     = os.str();
+  doc.numTags = numWidgets + 2;
+
+  return doc;
+}
+
+// table widget with n rows of 4 items
+Document tableRows(int n) {
+  Document doc;
+
+  std::ostringstream os;
+
+  os << "<qxml>\n<QTableWidget rowCount=\"" << n << "\" columnCount=\"4\">\n";
+
+  for (int r = 0; r < n; ++r)
+    for (int c = 0; c < 4; ++c)
+      os << "<QTableItem row=\"" << r << "\" column=\"" << c << "\">" <<
+            r << "," << c << "</QTableItem>\n";
+
+  os << "</QTableWidget>\n</qxml>\n";
+
+  doc.xml     = os.str();
+  doc.numTags = 4*n + 2;
+
+  return doc;
+}
+
+Document tableRowsBatch(int n) {
+  auto doc = tableRows(n);
+
+  doc.batchItems = true;
+
+  return doc;
+}
+
+// same for read-only model of plain table view
+Document tableViewRows(int n) {
+  Document doc;
+
+  std::ostringstream os;
+
+  os << "<qxml>\n<QTableView>\n";
+
+  for (int r = 0; r < n; ++r)
+    for (int c = 0; c < 4; ++c)
+      os << "<QTableItem row=\"" << r << "\" column=\"" << c << "\">" <<
+            r << "," << c << "</QTableItem>\n";
+
+  os << "</QTableView>\n</qxml>\n";
+
+  doc.xml     = os.str();
+  doc.numTags = 4*n + 2;
+
+  return doc;
+}
+
+// n widgets of the same class (property setters resolved once per class)
+Document sameClass(int n) {
+  Document doc;
+
+  std::ostringstream os;
+
+  os << "<qxml>\n<QVBoxLayout>\n";
+
+  for (int i = 0; i < n; ++i)
+    os << "<QPushButton toolTip=\"tip\" checkable=\"true\">Button</QPushButton>\n";
+
+  os << "</QVBoxLayout>\n</qxml>\n";
+
+  doc.xml     = os.str();
+  doc.numTags = n + 2;
+
+  return doc;
+}
+
+// n widgets cycling through different classes
+Document mixedClass(int n) {
+  static const char *classes[] = {
+    "QPushButton", "QLabel", "QCheckBox", "QLineEdit", "QSpinBox", "QComboBox",
+    "QToolButton", "QRadioButton"
+  };
+
+  const int numClasses = int(sizeof(classes)/sizeof(classes[0]));
+
+  Document doc;
+
+  std::ostringstream os;
+
+  os << "<qxml>\n<QVBoxLayout>\n";
+
+  for (int i = 0; i < n; ++i) {
+    const char *name = classes[i % numClasses];
+
+    os << "<" << name << " toolTip=\"tip\" enabled=\"true\"/>\n";
+  }
+
+  os << "</QVBoxLayout>\n</qxml>\n";
+
+  doc.xml     = os.str();
+  doc.numTags = n + 2;
+
+  return doc;
+}
+
+// load doc into new parent using mode. Returns false on failure
+bool load(CQXml *xml, const Document &doc, const QString &mode, const std::string &binFile,
+          QWidget *parent) {
+  if (mode == "binary")
+    return xml->createWidgetsFromBinary(parent, binFile);
+
+  return xml->createWidgetsFromString(parent, doc.xml);
+}
+
+CQXml *newXml(const Document &doc, const QString &mode) {
+  auto *xml = new CQXml;
+
+  xml->setStats(true);
+  xml->setBatchItems(doc.batchItems);
+
+  xml->setStreaming     (mode == "stream"  );
+  xml->setArenaBuild    (mode == "arena"   );
+  xml->setCacheTemplates(mode == "template");
+
+  return xml;
+}
+
+Result run(const Scenario &scenario, const Document &doc, int reps) {
+  const auto &mode = scenario.mode;
+
+  Result result;
+
+  result.name    = scenario.generator->name;
+  result.param   = scenario.generator->param;
+  result.mode    = mode;
+  result.size    = scenario.size;
+  result.numTags = doc.numTags;
+
+  // binary form is compiled before timing
+  std::string binFile;
+
+  if (mode == "binary") {
+    auto base = QDir::temp().filePath(QString("CQXmlBench%1").
+                                        arg(QCoreApplication::applicationPid()));
+
+    QFile file(base + ".xml");
+
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      file.write(doc.xml.c_str(), qint64(doc.xml.size()));
+      file.close();
+    }
+
+    binFile = (base + ".bin").toStdString();
+
+    CQXml xml;
+
+    if (! xml.compile(file.fileName().toStdString(), binFile))
+      std::cerr << "Failed to compile " << result.name << " " << result.size << "\n";
+
+    file.remove();
+  }
+
+  result.baseRSSKb = currentRSS();
+
+  for (int rep = 0; rep < reps; ++rep) {
+    auto *xml = newXml(doc, mode);
+
+    // first load parses and caches template, timed load reuses it
+    if (mode == "template") {
+      auto *parent = new QWidget;
+
+      (void) load(xml, doc, mode, binFile, parent);
+
+      delete parent;
+
+      xml->stats()->clear();
+    }
+
+    auto *parent = new QWidget;
+
+    long allocs = s_numAllocs;
+
+    QElapsedTimer timer;
+
+    timer.start();
+
+    if (! load(xml, doc, mode, binFile, parent))
+      std::cerr << "Failed to load " << result.name << " " << result.size << "\n";
+
+    qint64 nsecs = timer.nsecsElapsed();
+
+    allocs = s_numAllocs - allocs;
+
+    qint64 parseNSecs = xml->stats()->phaseTotal(CQXmlStats::Phase::PARSE).nsecs;
+    qint64 buildNSecs = nsecs - parseNSecs;
+
+    // keep fastest run
+    if (rep == 0 || parseNSecs + buildNSecs < result.parseNSecs + result.buildNSecs) {
+      result.parseNSecs   = parseNSecs;
+      result.buildNSecs   = buildNSecs;
+      result.allocsPerTag = double(allocs)/std::max(doc.numTags, 1);
+    }
+
+    delete parent;
+    delete xml;
+  }
+
+  result.peakRSSKb = peakRSS();
+
+  if (binFile.size())
+    QFile::remove(binFile.c_str());
+
+  return result;
+}
+
+QJsonObject toJson(const Result &result) {
+  QJsonObject obj;
+
+  double nsecs = double(result.parseNSecs + result.buildNSecs);
+
+  obj["scenario"    ] = QString(result.name.c_str());
+  obj["param"       ] = QString(result.param.c_str());
+  obj["mode"        ] = result.mode;
+  obj["size"        ] = result.size;
+  obj["numTags"     ] = result.numTags;
+  obj["parseNSecs"  ] = double(result.parseNSecs);
+  obj["buildNSecs"  ] = double(result.buildNSecs);
+  obj["nsecsPerTag" ] = nsecs/std::max(result.numTags, 1);
+  obj["allocsPerTag"] = result.allocsPerTag;
+  obj["baseRSSKb"   ] = double(result.baseRSSKb);
+  obj["peakRSSKb"   ] = double(result.peakRSSKb);
+  obj["rssDeltaKb"  ] = double(result.peakRSSKb - result.baseRSSKb);
+
+  return obj;
+}
+
+//------
+
+// tag owner lookup before and after storing owner on tag. Emulates parent chain of a
+// document nested to depth (2*depth + 2 tags) where each tag looks up its owner a
+// few times during build
+struct OwnerNode {
+  virtual ~OwnerNode() { }
+
+  OwnerNode *parent { nullptr };
+};
+
+struct OwnerTag : public OwnerNode {
+  virtual bool isRoot() const { return false; }
+
+  CQXml *xml { nullptr };
+};
+
+struct OwnerRoot : public OwnerTag {
+  bool isRoot() const override { return true; }
+};
+
+// old CQXmlTag::getXml
+CQXml *walkOwner(const OwnerTag *tag) {
+  auto *parent = dynamic_cast<OwnerTag *>(tag->parent);
+
+  while (parent && ! parent->isRoot())
+    parent = dynamic_cast<OwnerTag *>(parent->parent);
+
+  if (parent)
+    return dynamic_cast<OwnerRoot *>(parent)->xml;
+
+  return nullptr;
+}
+
+QJsonObject compareOwnerLookup(int depth, int reps) {
+  const int lookupsPerTag = 4;
+
+  CQXml xml;
+
+  OwnerRoot root;
+
+  root.xml = &xml;
+
+  std::vector<std::unique_ptr<OwnerTag>> tags;
+
+  OwnerNode *parent = &root;
+
+  for (int i = 0; i < 2*depth + 1; ++i) {
+    auto *tag = new OwnerTag;
+
+    tag->parent = parent;
+    tag->xml    = &xml;
+
+    tags.emplace_back(tag);
+
+    parent = tag;
+  }
+
+  CQXml * volatile sink = nullptr;
+
+  auto time = [&](std::function<CQXml *(const OwnerTag *)> lookup) {
+    qint64 best = 0;
+
+    for (int rep = 0; rep < reps; ++rep) {
+      QElapsedTimer timer;
+
+      timer.start();
+
+      for (const auto &tag : tags)
+        for (int i = 0; i < lookupsPerTag; ++i)
+          sink = lookup(tag.get());
+
+      qint64 nsecs = timer.nsecsElapsed();
+
+      if (rep == 0 || nsecs < best)
+        best = nsecs;
+    }
+
+    return best;
+  };
+
+  qint64 before = time(walkOwner);
+  qint64 after  = time([](const OwnerTag *tag) { return tag->xml; });
+
+  (void) sink;
+
+  QJsonObject obj;
+
+  obj["comparison" ] = "ownerLookup";
+  obj["param"      ] = "nesting depth";
+  obj["size"       ] = depth;
+  obj["numTags"    ] = int(tags.size() + 1);
+  obj["beforeNSecs"] = double(before);
+  obj["afterNSecs" ] = double(after);
+  obj["speedup"    ] = double(before)/std::max(after, qint64(1));
+
+  return obj;
+}
+
+// property setting before and after per class setter plans. Sets the same attributes
+// on n buttons using the old per widget name lookup, value conversion and enum key
+// scan and using properties, types and enum values resolved once for the class
+QJsonObject comparePropertySetters(int n, int reps) {
+  using NameValue  = std::pair<QString, QString>;
+  using NameValues = std::vector<NameValue>;
+
+  NameValues nameValues = {
+    {"toolTip"        , "tip"        },
+    {"checkable"      , "true"       },
+    {"flat"           , "false"      },
+    {"autoDefault"    , "false"      },
+    {"focusPolicy"    , "StrongFocus"},
+    {"layoutDirection", "RightToLeft"}
+  };
+
+  std::vector<std::unique_ptr<QPushButton>> buttons;
+
+  for (int i = 0; i < n; ++i)
+    buttons.emplace_back(new QPushButton);
+
+  // old CQXmlQtWidgetTag::createWidgetI property loop
+  auto setBefore = [&](QWidget *w) {
+    const auto *meta = w->metaObject();
+
+    for (const auto &nameValue : nameValues) {
+      int propIndex = meta->indexOfProperty(nameValue.first.toLatin1());
+      if (propIndex < 0) continue;
+
+      auto mP = meta->property(propIndex);
+      if (! mP.isWritable()) continue;
+
+      if (mP.isEnumType()) {
+        auto me = mP.enumerator();
+
+        for (int i = 0; i < me.keyCount(); ++i) {
+          if (me.key(i) == nameValue.second)
+            (void) w->setProperty(nameValue.first.toLatin1(), me.value(i));
+        }
+      }
+      else {
+        QVariant v(nameValue.second);
+
+        if (! v.convert(int(mP.type())))
+          continue;
+
+        (void) w->setProperty(nameValue.first.toLatin1(), v);
+      }
+    }
+  };
+
+  // plan per (class, attribute) built on first use as CQXmlPropertyPlan
+  struct Plan {
+    bool               valid  { false };
+    QMetaProperty      prop;
+    int                type   { QVariant::Invalid };
+    bool               isEnum { false };
+    QHash<QString,int> enumValues;
+  };
+
+  using PlanKey = QPair<const QMetaObject *, QString>;
+
+  QHash<PlanKey, Plan> plans;
+
+  auto getPlan = [&](const QMetaObject *meta, const QString &name) -> const Plan & {
+    auto p = plans.find(PlanKey(meta, name));
+
+    if (p != plans.end())
+      return p.value();
+
+    Plan plan;
+
+    int propIndex = meta->indexOfProperty(name.toLatin1());
+
+    if (propIndex >= 0) {
+      plan.prop   = meta->property(propIndex);
+      plan.valid  = plan.prop.isWritable();
+      plan.type   = int(plan.prop.type());
+      plan.isEnum = plan.prop.isEnumType();
+
+      if (plan.isEnum) {
+        auto me = plan.prop.enumerator();
+
+        for (int i = 0; i < me.keyCount(); ++i)
+          plan.enumValues[me.key(i)] = me.value(i);
+      }
+    }
+
+    return plans.insert(PlanKey(meta, name), plan).value();
+  };
+
+  auto setAfter = [&](QWidget *w) {
+    for (const auto &nameValue : nameValues) {
+      const auto &plan = getPlan(w->metaObject(), nameValue.first);
+      if (! plan.valid) continue;
+
+      if (plan.isEnum) {
+        auto p = plan.enumValues.find(nameValue.second);
+
+        if (p != plan.enumValues.end())
+          (void) plan.prop.write(w, p.value());
+      }
+      else {
+        QVariant v(nameValue.second);
+
+        if (v.convert(plan.type))
+          (void) plan.prop.write(w, v);
+      }
+    }
+  };
+
+  auto time = [&](std::function<void (QWidget *)> setProperties) {
+    qint64 best = 0;
+
+    for (int rep = 0; rep < reps; ++rep) {
+      plans.clear();
+
+      QElapsedTimer timer;
+
+      timer.start();
+
+      for (const auto &button : buttons)
+        setProperties(button.get());
+
+      qint64 nsecs = timer.nsecsElapsed();
+
+      if (rep == 0 || nsecs < best)
+        best = nsecs;
+    }
+
+    return best;
+  };
+
+  qint64 before = time(setBefore);
+  qint64 after  = time(setAfter);
+
+  QJsonObject obj;
+
+  obj["comparison" ] = "propertySetters";
+  obj["param"      ] = "widgets";
+  obj["size"       ] = n;
+  obj["numTags"    ] = n;
+  obj["beforeNSecs"] = double(before);
+  obj["afterNSecs" ] = double(after);
+  obj["speedup"    ] = double(before)/std::max(after, qint64(1));
+
+  return obj;
+}
+
+// tag attribute storage before and after interned attribute ids. Stores n attributes
+// on each of 1000 tags (from CXML option strings) and looks up the attributes a
+// build reads, using the old per tag map keyed by name and the flat (id, value) array
+// with names interned in a shared read locked table
+QJsonObject compareAttributeStorage(int n, int reps) {
+  const int numTags = 1000;
+
+  static const char *fixedNames[] = {
+    "name", "text", "row", "col", "icon", "toolTip", "enabled", "minimumWidth"
+  };
+
+  const int numFixed = int(sizeof(fixedNames)/sizeof(fixedNames[0]));
+
+  using Options = std::vector<std::pair<std::string, std::string>>;
+
+  Options options;
+
+  for (int i = 0; i < n; ++i) {
+    std::string name = (i < numFixed ? std::string(fixedNames[i]) :
+                                       "attr" + std::to_string(i));
+
+    options.push_back(std::make_pair(name, std::to_string(i)));
+  }
+
+  // names looked up by build for every tag
+  QStringList lookups = { "name", "text", "icon", "row", "col", "lazy" };
+
+  // shared name table (as CQXmlAttr)
+  QReadWriteLock      lock;
+  QHash<QString, int> ids;
+
+  auto findId = [&](const QString &name) {
+    QReadLocker locker(&lock);
+
+    auto p = ids.find(name);
+
+    return (p != ids.end() ? p.value() : -1);
+  };
+
+  auto internId = [&](const QString &name) {
+    int id = findId(name);
+
+    if (id >= 0)
+      return id;
+
+    QWriteLocker locker(&lock);
+
+    auto p = ids.find(name);
+
+    if (p != ids.end())
+      return p.value();
+
+    id = ids.size();
+
+    ids[name] = id;
+
+    return id;
+  };
+
+  std::vector<int> lookupIds;
+
+  for (const auto &name : lookups)
+    lookupIds.push_back(internId(name));
+
+  volatile int sink = 0;
+
+  // old CQXmlTag storage
+  auto storeBefore = [&]() {
+    for (int t = 0; t < numTags; ++t) {
+      std::map<QString, QString> nameValues;
+
+      for (const auto &option : options)
+        nameValues[option.first.c_str()] = option.second.c_str();
+
+      for (const auto &name : lookups) {
+        auto p = nameValues.find(name);
+
+        if (p != nameValues.end())
+          sink = sink + (*p).second.length();
+      }
+    }
+  };
+
+  struct NameValue {
+    int     id { -1 };
+    QString value;
+  };
+
+  auto storeAfter = [&]() {
+    for (int t = 0; t < numTags; ++t) {
+      std::vector<NameValue> nameValues;
+
+      nameValues.reserve(options.size());
+
+      for (const auto &option : options)
+        nameValues.push_back(NameValue { internId(option.first.c_str()),
+                                         option.second.c_str() });
+
+      for (auto id : lookupIds) {
+        for (const auto &nameValue : nameValues) {
+          if (nameValue.id == id) {
+            sink = sink + nameValue.value.length();
+            break;
+          }
+        }
+      }
+    }
+  };
+
+  auto time = [&](std::function<void ()> store, double &allocsPerTag) {
+    qint64 best = 0;
+
+    for (int rep = 0; rep < reps; ++rep) {
+      long allocs = s_numAllocs;
+
+      QElapsedTimer timer;
+
+      timer.start();
+
+      store();
+
+      qint64 nsecs = timer.nsecsElapsed();
+
+      allocs = s_numAllocs - allocs;
+
+      if (rep == 0 || nsecs < best) {
+        best         = nsecs;
+        allocsPerTag = double(allocs)/numTags;
+      }
+    }
+
+    return best;
+  };
+
+  double beforeAllocs = 0.0, afterAllocs = 0.0;
+
+  qint64 before = time(storeBefore, beforeAllocs);
+  qint64 after  = time(storeAfter , afterAllocs );
+
+  (void) sink;
+
+  QJsonObject obj;
+
+  obj["comparison"        ] = "attributeStorage";
+  obj["param"             ] = "attributes/tag";
+  obj["size"              ] = n;
+  obj["numTags"           ] = numTags;
+  obj["beforeNSecs"       ] = double(before);
+  obj["afterNSecs"        ] = double(after);
+  obj["speedup"           ] = double(before)/std::max(after, qint64(1));
+  obj["beforeAllocsPerTag"] = beforeAllocs;
+  obj["afterAllocsPerTag" ] = afterAllocs;
+
+  return obj;
+}
+
+// run scenario in child process and return its result (empty on failure)
+QJsonObject runChild(const Scenario &scenario, int reps) {
+  QStringList args;
+
+  args << "-run" << scenario.generator->name.c_str() << QString::number(scenario.size) <<
+          "-mode" << scenario.mode << "-reps" << QString::number(reps);
+
+  QProcess process;
+
+  process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+  process.start(QCoreApplication::applicationFilePath(), args);
+
+  if (! process.waitForFinished(-1) || process.exitCode() != 0) {
+    std::cerr << "Failed to run " << scenario.generator->name << " " <<
+                 scenario.size << " (" << scenario.mode.toStdString() << ")\n";
+    return QJsonObject();
+  }
+
+  return QJsonDocument::fromJson(process.readAllStandardOutput()).object();
+}
+
+// run each rep of scenario in new child process and return fastest result
+QJsonObject runCold(const Scenario &scenario, int reps) {
+  QJsonObject best;
+
+  auto total = [](const QJsonObject &obj) {
+    return obj["parseNSecs"].toDouble() + obj["buildNSecs"].toDouble();
+  };
+
+  for (int rep = 0; rep < reps; ++rep) {
+    auto result = runChild(scenario, 1);
+
+    if (! result.isEmpty() && (best.isEmpty() || total(result) < total(best)))
+      best = result;
+  }
+
+  return best;
+}
+
+// cold start time of binary mode against tree and stream modes for same scenario
+// and size (missing modes are skipped)
+QJsonObject compareColdStart(const QJsonArray &results, const QJsonObject &binary) {
+  auto total = [](const QJsonObject &obj) {
+    return obj["parseNSecs"].toDouble() + obj["buildNSecs"].toDouble();
+  };
+
+  QJsonObject obj;
+
+  obj["scenario"   ] = binary["scenario"];
+  obj["size"       ] = binary["size"];
+  obj["binaryNSecs"] = total(binary);
+
+  for (const auto &value : results) {
+    auto result = value.toObject();
+
+    if (result["scenario"] != binary["scenario"] || result["size"] != binary["size"])
+      continue;
+
+    auto mode = result["mode"].toString();
+
+    if (mode != "tree" && mode != "stream")
+      continue;
+
+    obj[mode + "NSecs"  ] = total(result);
+    obj[mode + "Speedup"] = total(result)/std::max(total(binary), 1.0);
+  }
+
+  return obj;
+}
+
+}
+
+//------
+
+int
+main(int argc, char **argv)
+{
+  using namespace CQXmlBench;
+
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+
+  int         reps    = 3;
+  double      scale   = 1.0;
+  QString     output;
+  QStringList names;
+  QStringList modes;
+  QString     runName;
+  int         runSize = 0;
+  bool        cold    = false;
+
+  static QStringList allModes = { "tree", "stream", "binary", "template", "arena" };
+
+  for (int i = 1; i < argc; ++i) {
+    QString arg = argv[i];
+
+    if      (arg == "-reps" && i < argc - 1)
+      reps = std::max(QString(argv[++i]).toInt(), 1);
+    else if (arg == "-scale" && i < argc - 1)
+      scale = std::max(QString(argv[++i]).toDouble(), 0.01);
+    else if (arg == "-mode" && i < argc - 1) {
+      QString mode = argv[++i];
+
+      if      (mode == "all")
+        modes = allModes;
+      else if (allModes.contains(mode))
+        modes << mode;
+      else {
+        std::cerr << "Invalid mode '" << mode.toStdString() << "'\n";
+        return 1;
+      }
+    }
+    else if (arg == "-cold")
+      cold = true;
+    else if (arg == "-o" && i < argc - 1)
+      output = argv[++i];
+    else if (arg == "-run" && i < argc - 2) {
+      runName = argv[++i];
+      runSize = QString(argv[++i]).toInt();
+    }
+    else if (arg.startsWith("-")) {
+      std::cerr << "Usage: CQXmlBench [-reps <n>] [-scale <f>] [-mode <mode>] ... "
+                   "[-cold] [-o <file.json>] [<scenario>|<comparison> ...]\n";
+      return 1;
+    }
+    else
+      names << arg;
+  }
+
+  if (modes.isEmpty())
+    modes << "tree";
+
+  iconDir = QDir::temp().filePath("CQXmlBenchIcons");
+
+  QDir().mkpath(iconDir);
+
+  std::vector<Generator> generators = {
+    {"tags"      , "tag count"     , labels        , {100, 1000, 10000}},
+    {"depth"     , "nesting depth" , depth         , {10, 50, 200}     },
+    {"attributes", "attributes/tag", attributes    , {1, 8, 32}        },
+    {"icons"     , "distinct icons", icons         , {1, 10, 100}      },
+    {"rows"      , "table rows"    , tableRows     , {1000, 10000}     },
+    {"rowsBatch" , "table rows"    , tableRowsBatch, {1000, 10000}     },
+    {"rowsModel" , "table rows"    , tableViewRows , {1000, 10000}     },
+    {"sameClass" , "widgets"       , sameClass     , {1000, 5000}      },
+    {"mixedClass", "widgets"       , mixedClass    , {1000, 5000}      }
+  };
+
+  // child process: run one scenario size and mode and write its result
+  if (runName.length()) {
+    for (const auto &generator : generators) {
+      if (runName != generator.name.c_str())
+        continue;
+
+      Scenario scenario;
+
+      scenario.generator = &generator;
+      scenario.size      = runSize;
+      scenario.mode      = modes[0];
+
+      auto result = run(scenario, generator.generate(runSize), reps);
+
+      std::cout << QJsonDocument(toJson(result)).toJson(QJsonDocument::Compact).toStdString();
+
+      return 0;
+    }
+
+    std::cerr << "Invalid scenario '" << runName.toStdString() << "'\n";
+
+    return 1;
+  }
+
+  auto isSelected = [&](const QString &name) {
+    return (names.isEmpty() || names.contains(name));
+  };
+
+  std::vector<Scenario> scenarios;
+
+  for (const auto &generator : generators) {
+    if (! isSelected(generator.name.c_str()))
+      continue;
+
+    for (const auto &mode : modes) {
+      for (auto size : generator.sizes) {
+        Scenario scenario;
+
+        scenario.generator = &generator;
+        scenario.size      = std::max(int(size*scale), 1);
+        scenario.mode      = mode;
+
+        scenarios.push_back(scenario);
+      }
+    }
+  }
+
+  QJsonArray results;
+
+  for (const auto &scenario : scenarios) {
+    auto result = (cold ? runCold(scenario, reps) : runChild(scenario, reps));
+
+    if (result.isEmpty())
+      continue;
+
+    std::cerr << scenario.generator->name << " " << scenario.size << " (" <<
+                 scenario.mode.toStdString() << "): parse " <<
+                 result["parseNSecs"].toDouble()/1000000.0 << "ms build " <<
+                 result["buildNSecs"].toDouble()/1000000.0 << "ms allocs/tag " <<
+                 result["allocsPerTag"].toDouble() << " peak RSS " <<
+                 result["peakRSSKb"].toDouble() << "KB (+" <<
+                 result["rssDeltaKb"].toDouble() << "KB)\n";
+
+    results.append(result);
+  }
+
+  QJsonArray coldStart;
+
+  if (cold) {
+    for (const auto &value : results) {
+      auto result = value.toObject();
+
+      if (result["mode"].toString() != "binary")
+        continue;
+
+      auto obj = compareColdStart(results, result);
+
+      std::cerr << "coldStart " << obj["scenario"].toString().toStdString() << " " <<
+                   obj["size"].toInt() << ": binary " <<
+                   obj["binaryNSecs"].toDouble()/1000000.0 << "ms";
+
+      for (const auto &mode : {QString("tree"), QString("stream")}) {
+        if (obj.contains(mode + "NSecs"))
+          std::cerr << " " << mode.toStdString() << " " <<
+                       obj[mode + "NSecs"].toDouble()/1000000.0 << "ms (speedup " <<
+                       obj[mode + "Speedup"].toDouble() << ")";
+      }
+
+      std::cerr << "\n";
+
+      coldStart.append(obj);
+    }
+  }
+
+  QJsonArray comparisons;
+
+  auto addComparison = [&](const QJsonObject &obj) {
+    std::cerr << obj["comparison"].toString().toStdString() << " " <<
+                 obj["size"].toInt() << ": before " <<
+                 obj["beforeNSecs"].toDouble()/1000000.0 << "ms after " <<
+                 obj["afterNSecs"].toDouble()/1000000.0 << "ms speedup " <<
+                 obj["speedup"].toDouble();
+
+    if (obj.contains("beforeAllocsPerTag"))
+      std::cerr << " allocs/tag " << obj["beforeAllocsPerTag"].toDouble() << " -> " <<
+                   obj["afterAllocsPerTag"].toDouble();
+
+    std::cerr << "\n";
+
+    comparisons.append(obj);
+  };
+
+  if (isSelected("ownerLookup")) {
+    for (auto depth : {10, 50, 200, 1000})
+      addComparison(compareOwnerLookup(std::max(int(depth*scale), 1), reps));
+  }
+
+  if (isSelected("propertySetters")) {
+    for (auto n : {100, 1000, 5000})
+      addComparison(comparePropertySetters(std::max(int(n*scale), 1), reps));
+  }
+
+  if (isSelected("attributeStorage")) {
+    for (auto n : {2, 8, 32})
+      addComparison(compareAttributeStorage(n, reps));
+  }
+
+  QJsonObject root;
+
+  root["reps"       ] = reps;
+  root["cold"       ] = cold;
+  root["results"    ] = results;
+  root["comparisons"] = comparisons;
+
+  if (cold)
+    root["coldStart"] = coldStart;
+
+  auto json = QJsonDocument(root).toJson();
+
+  if (output.length()) {
+    QFile file(output);
+
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      std::cerr << "Failed to write '" << output.toStdString() << "'\n";
+      return 1;
+    }
+
+    file.write(json);
+  }
+  else
+    std::cout << json.toStdString();
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+// generate C++ class from CQXml file (setupUi creates the widgets directly and named
+// widgets, layouts and actions have typed accessors)
+//
+// usage: CQXmlGen <file.xml> <ClassName> [-o <basename>]
+//
+// writes <basename>.h and <basename>.cpp (basename defaults to class name). Runs with
+// the offscreen platform unless QT_QPA_PLATFORM is already set
+
+#include <CQXml.h>
+
+#include <QApplication>
+
+#include <iostream>
+
+int
+main(int argc, char **argv)
+{
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  // widget classes are looked up from prototype widgets so needs application
+  QApplication app(argc, argv);
+
+  QString     output;
+  QStringList args;
+
+  for (int i = 1; i < argc; ++i) {
+    QString arg = argv[i];
+
+    if      (arg == "-o" && i < argc - 1)
+      output = argv[++i];
+    else if (arg.startsWith("-")) {
+      args.clear();
+      break;
+    }
+    else
+      args << arg;
+  }
+
+  if (args.length() != 2) {
+    std::cerr << "Usage: CQXmlGen <file.xml> <ClassName> [-o <basename>]\n";
+    return 1;
+  }
+
+  if (output.isEmpty())
+    output = args[1];
+
+  CQXml xml;
+
+  if (! xml.generateCode(args[0].toStdString(), args[1].toStdString(),
+                         (output + ".h").toStdString(), (output + ".cpp").toStdString())) {
+    std::cerr << "Failed to generate code for '" << args[0].toStdString() << "'\n";
+    return 1;
+  }
+
+  return 0;
+}
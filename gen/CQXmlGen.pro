@@ -0,0 +1,34 @@
+TEMPLATE = app
+
+TARGET = CQXmlGen
+
+DEPENDPATH += .
+
+QT += widgets concurrent printsupport webkitwidgets
+
+CONFIG += release
+
+# Input
+SOURCES += \
+CQXmlGen.cpp \
+
+DESTDIR     = .
+OBJECTS_DIR = .
+
+INCLUDEPATH += \
+../include \
+.
+
+unix:LIBS += \
+-L../lib \
+-L../../CQStyleWidget/lib \
+-L../../CQColorPalette/lib \
+-L../../CQUtil/lib \
+-L../../CXML/lib \
+-L../../CFile/lib \
+-L../../COS/lib \
+-L../../CStrUtil/lib \
+-L../../CRegExp/lib \
+-lCQXml -lCQStyleWidget -lCQColorPalette -lCQUtil \
+-lCXML -lCFile -lCOS -lCStrUtil -lCRegExp \
+-ltre
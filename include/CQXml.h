@@ -3,10 +3,22 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <set>
+#include <functional>
 
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QPixmap>
+#include <QImage>
+#include <QHash>
+#include <QPointer>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QAtomicInt>
 
 #include <CXML.h>
 #include <CXMLTag.h>
@@ -14,9 +26,32 @@
 class CQXmlTag;
 class CQXmlFactory;
 
+struct CQXmlTemplate;
+struct CQXmlDeferred;
+struct CQXmlReloadState;
+class  CQXmlTrace;
+
 class QWidget;
 class QLayout;
 class QAction;
+class QXmlStreamReader;
+class QAbstractItemModel;
+class QTreeWidgetItem;
+class QFileSystemWatcher;
+class QTimer;
+
+template<typename T> class QFutureWatcher;
+
+//----
+
+// widgets whose creation is postponed by lazy options
+enum class CQXmlDeferredType {
+  PAGE,    // tab widget, tool box or stacked widget page (widget is placeholder)
+  DIALOG,  // top level dialog (no widget)
+  MENU,    // menu contents (widget is menu)
+  DOCK,    // dock widget contents (widget is dock)
+  ITEM     // tree widget item children (widget is tree, item is parent item)
+};
 
 //----
 
@@ -31,6 +66,9 @@ class CQXmlWidgetFactory {
   virtual ~CQXmlWidgetFactory() { }
 
   virtual QWidget *createWidget(const QStringList &params=QStringList()) = 0;
+
+  // class of created widget (if known without creating one)
+  virtual const QMetaObject *metaObject() const { return nullptr; }
 };
 
 //----
@@ -43,6 +81,10 @@ class CQXmlWidgetFactoryT : public CQXmlWidgetFactory {
   QWidget *createWidget(const QStringList &) override {
     return new T;
   }
+
+  const QMetaObject *metaObject() const override {
+    return &T::staticMetaObject;
+  }
 };
 
 #define CQXmlAddWidgetFactoryT(XML, N) \
@@ -78,6 +120,189 @@ class CQXmlTagFactoryT : public CQXmlTagFactory {
 
 //----
 
+// creates item model for item view 'model' attribute value "<scheme>:<source>"
+class CQXmlModelFactory {
+ public:
+  CQXmlModelFactory() { }
+
+  virtual ~CQXmlModelFactory() { }
+
+  virtual QAbstractItemModel *createModel(const QString &source, QObject *parent) = 0;
+};
+
+//----
+
+// factories registered for a tag name and which one is used
+struct CQXmlFactoryHandle {
+  enum class Type {
+    NONE,
+    ROOT,
+    TAG,
+    WIDGET
+  };
+
+  Type                type          { Type::NONE };
+  CQXmlTagFactory*    tagFactory    { nullptr };
+  CQXmlWidgetFactory* widgetFactory { nullptr };
+  int                 generation    { 0 }; // CQXml::factoryGeneration at lookup
+};
+
+//----
+
+// build timings aggregated per phase and per tag name, widget class or icon file
+class CQXmlStats {
+ public:
+  enum class Phase {
+    PARSE,       // document parse (includes tag creation)
+    CREATE_TAG,  // tag creation (per tag name)
+    CONSTRUCT,   // widget construction (per widget class)
+    PROPERTIES,  // text and property setting (per widget class)
+    SIZES,       // size attributes (per widget class)
+    ICON_DECODE, // icon decode (per file name)
+    END_LAYOUT   // layout finish (per tag name)
+  };
+
+  struct Entry {
+    Phase   phase { Phase::PARSE };
+    QString name;
+    qint64  count { 0 };
+    qint64  nsecs { 0 };
+  };
+
+  using Entries = std::vector<Entry>;
+
+ public:
+  CQXmlStats() { }
+
+  void add(Phase phase, const QString &name, qint64 nsecs);
+
+  void clear();
+
+  // entries ordered by phase then name
+  Entries entries() const;
+
+  // total time and count for phase
+  Entry phaseTotal(Phase phase) const;
+
+  static QString phaseName(Phase phase);
+
+  QString toJson() const;
+  QString toCsv() const;
+
+  bool writeJson(const QString &filename) const;
+  bool writeCsv (const QString &filename) const;
+
+ private:
+  using Key      = std::pair<int, QString>;
+  using EntryMap = std::map<Key, Entry>;
+
+  mutable QMutex mutex_;
+  EntryMap       entries_;
+};
+
+//----
+
+// decoded image files (for icon attributes) with byte budget and LRU eviction.
+//
+// When async decode is enabled icon files named in tag attributes are decoded to
+// QImage on the thread pool while the document is parsed and converted to QPixmap
+// in the gui thread when first used. With placeholders enabled, use of a pixmap
+// still being decoded returns the placeholder and the real pixmap is patched in
+// when decoding finishes.
+class CQXmlIconCache : public QObject {
+  Q_OBJECT
+
+ public:
+  using PixmapSetter = std::function<void (const QPixmap &)>;
+
+ public:
+  CQXmlIconCache(qint64 maxBytes=16*1024*1024);
+
+ ~CQXmlIconCache();
+
+  qint64 maxBytes() const { return maxBytes_; }
+  void setMaxBytes(qint64 n);
+
+  qint64 numBytes() const { return numBytes_; }
+
+  int numEntries() const { return entries_.size(); }
+
+  int hits     () const { return hits_     ; }
+  int misses   () const { return misses_   ; }
+  int evictions() const { return evictions_; }
+
+  bool isAsyncDecode() const { return asyncDecode_; }
+  void setAsyncDecode(bool b) { asyncDecode_ = b; }
+
+  bool isPlaceholders() const { return placeholders_; }
+  void setPlaceholders(bool b) { placeholders_ = b; }
+
+  const QPixmap &placeholder() const { return placeholder_; }
+  void setPlaceholder(const QPixmap &pixmap) { placeholder_ = pixmap; }
+
+  // start decode of file (can be called from any thread)
+  Q_INVOKABLE void prefetch(const QString &filename);
+
+  // add image decoded by caller (ignored if file is already cached or being decoded)
+  void addImage(const QString &filename, const QImage &image);
+
+  QPixmap pixmap(const QString &filename);
+  QPixmap pixmap(const QString &filename, QObject *target, const PixmapSetter &setter);
+
+  void clear();
+
+  // record decode times (if non-null)
+  void setStats(CQXmlStats *stats) { stats_ = stats; }
+
+ private Q_SLOTS:
+  void decodedSlot();
+
+ private:
+  struct Patch {
+    QPointer<QObject> target;
+    PixmapSetter      setter;
+  };
+
+  using Patches = std::vector<Patch>;
+
+  // decode in progress and its patches (defined in source with decode map)
+  struct Pending;
+  struct PendingMap;
+
+  QPixmap finishPending(const QString &filename, const Pending &pending, bool used);
+
+  QPixmap addPixmap(const QString &filename, const QPixmap &pixmap, bool used);
+
+  void evict();
+
+ private:
+  using LRUList = std::list<QString>;
+
+  struct Entry {
+    QPixmap           pixmap;
+    qint64            bytes { 0 };
+    bool              used  { false }; // looked up since added (for hit count)
+    LRUList::iterator pos;
+  };
+
+  using Entries = QHash<QString, Entry>;
+
+  qint64      maxBytes_     { 0 };
+  qint64      numBytes_     { 0 };
+  Entries     entries_;
+  LRUList     lru_;
+  PendingMap* pending_      { nullptr };
+  bool        asyncDecode_  { false };
+  bool        placeholders_ { false };
+  QPixmap     placeholder_;
+  int         hits_         { 0 };
+  int         misses_       { 0 };
+  int         evictions_    { 0 };
+  CQXmlStats* stats_        { nullptr };
+};
+
+//----
+
 class CQXml : public QObject {
   Q_OBJECT
 
@@ -92,19 +317,195 @@ class CQXml : public QObject {
 
   CQXmlFactory *getFactory() const { return factory_; }
 
+  CQXmlIconCache *iconCache() const { return iconCache_; }
+
+  // record build timings in stats (stats are kept when disabled)
+  bool isStats() const { return statsEnabled_; }
+  void setStats(bool b);
+
+  CQXmlStats *stats() const { return stats_; }
+
+  // record nested begin/end events for parse and each tag built until stopTrace
+  // which writes them as Chrome trace event JSON (chrome://tracing, Perfetto)
+  void startTrace();
+  bool stopTrace(const QString &filename);
+
+  CQXmlTrace *trace() const { return trace_; }
+
   bool isWidgetFactory(const QString &name) const;
   void addWidgetFactory(const QString &name, CQXmlWidgetFactory *factory);
   void removeWidgetFactory(const QString &name);
   CQXmlWidgetFactory *getWidgetFactory(const QString &name) const;
 
+  // changed when a widget factory is replaced or removed. Widget tags of kept tag
+  // trees and templates look their factory up again when it has changed
+  int factoryGeneration() const { return factoryGeneration_.loadAcquire(); }
+
   bool isTagFactory(const QString &name) const;
   void addTagFactory(const QString &name, CQXmlTagFactory *factory);
   void removeTagFactory(const QString &name);
   CQXmlTagFactory *getTagFactory(const QString &name) const;
 
+  bool isModelFactory(const QString &scheme) const;
+  void addModelFactory(const QString &scheme, CQXmlModelFactory *factory);
+  void removeModelFactory(const QString &scheme);
+  CQXmlModelFactory *getModelFactory(const QString &scheme) const;
+
+  // create model for "<scheme>:<source>" string
+  QAbstractItemModel *createModel(const QString &str, QObject *parent) const;
+
+  // path relative to directory of loaded file (unchanged if absolute or no file)
+  QString filePath(const QString &path) const;
+
+  // single hashed lookup of root, tag or widget factory for tag name (can be called
+  // from any thread)
+  CQXmlFactoryHandle lookupFactory(const std::string &name) const;
+
+  // build widgets directly from parser events (no retained tag tree)
+  bool isStreaming() const { return streaming_; }
+  void setStreaming(bool b) { streaming_ = b; }
+
+  // free parse tree after widgets are built (only name to object maps are kept)
+  bool isDiscardParseTree() const { return discardParseTree_; }
+  void setDiscardParseTree(bool b) { discardParseTree_ = b; }
+
+  // free parse tree kept from last load (tags of widgets not yet created by lazy
+  // options are freed when they are created)
+  void releaseParseTree();
+
+  // approximate parse tree bytes currently kept (last tree and cached templates)
+  // and freed so far
+  struct ParseMemory {
+    qint64 retainedBytes { 0 };
+    qint64 releasedBytes { 0 };
+  };
+
+  ParseMemory parseMemory() const;
+
+  // allocate tags from a single arena released when the build finishes (tag tree
+  // is not kept so instantiate is not available, ignored when caching templates)
+  bool isArenaBuild() const { return arenaBuild_; }
+  void setArenaBuild(bool b) { arenaBuild_ = b; }
+
+  // keep parsed tag trees (keyed by file name and modification time or by string
+  // hash) so loading the same form again only runs widget construction
+  bool isCacheTemplates() const { return cacheTemplates_; }
+  void setCacheTemplates(bool b) { cacheTemplates_ = b; }
+
+  int templateCacheHits  () const { return templateCacheHits_  ; }
+  int templateCacheMisses() const { return templateCacheMisses_; }
+
+  void clearTemplateCache();
+
+  // create only current page of tab widgets, tool boxes and stacked widgets, other
+  // pages are created when first made current (per widget 'lazy' attribute overrides)
+  bool isLazyPages() const { return lazyPages_; }
+  void setLazyPages(bool b) { lazyPages_ = b; }
+
+  // create named dialogs when first looked up (getWidget) instead of at load
+  bool isLazyDialogs() const { return lazyDialogs_; }
+  void setLazyDialogs(bool b) { lazyDialogs_ = b; }
+
+  // add menu contents when menu is first about to show
+  bool isLazyMenus() const { return lazyMenus_; }
+  void setLazyMenus(bool b) { lazyMenus_ = b; }
+
+  // create dock widget contents when dock widget first becomes visible
+  bool isLazyDocks() const { return lazyDocks_; }
+  void setLazyDocks(bool b) { lazyDocks_ = b; }
+
+  // add all QListItem, QTableItem and QTreeItem tags of an item widget in one step
+  // (items of plain QListView, QTableView and QTreeView without a model attribute
+  // always use a read-only model)
+  bool isBatchItems() const { return batchItems_; }
+  void setBatchItems(bool b) { batchItems_ = b; }
+
+  // create child items of nested QTreeItem tags when parent item is first expanded.
+  // Creation is triggered by QTreeWidget::itemExpanded (user or setExpanded) which
+  // QTreeView::expandAll and expandToDepth do not emit, so call buildDeferred before
+  // expanding items that way
+  bool isLazyTreeItems() const { return lazyTreeItems_; }
+  void setLazyTreeItems(bool b) { lazyTreeItems_ = b; }
+
+  // create widgets in slices of at most buildSlice ms resumed from the event loop so
+  // large forms do not block painting and input. buildProgress is emitted after each
+  // slice and buildFinished when all widgets exist (ignored when tag tree is not kept)
+  bool isIncrementalBuild() const { return incrementalBuild_; }
+  void setIncrementalBuild(bool b) { incrementalBuild_ = b; }
+
+  int buildSlice() const { return buildSlice_; }
+  void setBuildSlice(int ms) { buildSlice_ = ms; }
+
+  // incremental build in progress
+  bool isBuilding() const { return buildFactory_ != nullptr; }
+
+  void startBuild(CQXmlFactory *factory, QWidget *parent);
+
+  // complete incremental build now
+  void finishBuild();
+
+  // number of widget subtrees not yet created
+  int numDeferred() const { return int(deferred_.size()); }
+
+  void addDeferred(CQXmlDeferred *deferred);
+
+  // forget deferred widgets (e.g. parent deleted) without creating them
+  void removeDeferred(CQXmlDeferred *deferred);
+
+  // create all deferred widgets
+  void buildDeferred();
+
   bool createWidgetsFromString(QWidget *parent, const std::string &str);
   bool createWidgetsFromFile  (QWidget *parent, const std::string &filename);
 
+  // read and parse file, convert property values and decode icons on a worker thread
+  // then create widgets on GUI thread (widgetsCreated is emitted when done). Returns
+  // false if parse could not be started
+  bool createWidgetsAsync(QWidget *parent, const std::string &filename);
+
+  // file to load into parent by createWidgetsFromFiles (rc is set by load)
+  struct FileLoad {
+    QWidget*    parent { nullptr };
+    std::string filename;
+    bool        rc     { false };
+  };
+
+  using FileLoads = std::vector<FileLoad>;
+
+  // parse files concurrently on thread pool (separate tag tree per file) and create
+  // their widgets on calling (GUI) thread in list order. Returns false if any load
+  // failed (tag tree of last loaded file is kept)
+  bool createWidgetsFromFiles(FileLoads &loads);
+
+  // create widgets from last loaded tag tree
+  bool instantiate(QWidget *parent);
+
+  // re-read file of last createWidgetsFromFile and apply differences to its widgets.
+  // Tags are matched by name attribute (or position) and only changed, added and
+  // removed tags are updated, created or deleted (the whole form is rebuilt when the
+  // tag tree of the last load was not kept). Deletes widgets so must not be called
+  // from a slot of a widget of the form
+  bool reload();
+
+  // watch file of last createWidgetsFromFile and reload when it changes. Bursts of
+  // changes are coalesced (reload starts watchDelay ms after last change) and file
+  // is parsed on a worker thread so only widget update is done on GUI thread
+  bool isWatchFile() const { return watchFile_; }
+  void setWatchFile(bool b);
+
+  int watchDelay() const { return watchDelay_; }
+  void setWatchDelay(int ms) { watchDelay_ = ms; }
+
+  // compile xml file to binary form image for createWidgetsFromBinary
+  bool compile(const std::string &filename, const std::string &binaryFilename);
+
+  bool createWidgetsFromBinary(QWidget *parent, const std::string &filename);
+
+  // generate C++ class (setupUi and typed accessors for named objects) which creates
+  // the widgets of xml file without parsing it at runtime
+  bool generateCode(const std::string &filename, const std::string &className,
+                    const std::string &headerFilename, const std::string &sourceFilename);
+
   void addLayout(const QString &name, QLayout *l);
   QLayout *getLayout(const QString &name) const;
 
@@ -126,24 +527,145 @@ class CQXml : public QObject {
 
   virtual void execSlot(const QString &str);
 
+ Q_SIGNALS:
+  // watched file reloaded (rc is false if file could not be parsed)
+  void fileReloaded(bool rc);
+
+  // widgets of createWidgetsAsync created (rc is false if file could not be parsed)
+  void widgetsCreated(QWidget *parent, bool rc);
+
+  // incremental build progress (value of maximum tags created)
+  void buildProgress(int value, int maximum);
+
+  void buildFinished();
+
  private Q_SLOTS:
   void onSlot();
 
+  void deferredPageSlot(int ind);
+  void deferredMenuSlot();
+  void deferredDockSlot(bool visible);
+  void deferredItemSlot(QTreeWidgetItem *item);
+
+  void watchFileSlot(const QString &filename);
+  void watchTimerSlot();
+  void watchParsedSlot();
+
+  void asyncParsedSlot();
+
+  void buildTimerSlot();
+
+ private:
+  bool parse(CXML *xml, const std::string &str, bool isFile, CXMLTag **tag);
+
+  bool streamWidgets(QXmlStreamReader &reader);
+
+  bool transientWidgets(QWidget *parent, const std::string &str, bool isFile);
+
+  void addTemplate(const QString &key, CQXmlTemplate *tmpl);
+
+  void buildDeferred(CQXmlDeferred *deferred);
+
+
+  void buildDeferredWidget(QWidget *widget, CQXmlDeferredType type);
+
+  bool buildDeferredName(const QString &name);
+
+  void updateFactoryType(CQXmlFactoryHandle &handle);
+
+  void resetTree();
+
+  void retireTree(CXML *xml, CQXmlFactory *factory);
+  void releaseTree(CQXmlFactory *factory);
+
+  CQXmlTemplate *parseTemplate(const std::string &filename);
+
+  void prepareTemplate(CQXmlTemplate *tmpl, bool decodeIcons);
+
+  bool applyTemplate(QWidget *parent, const std::string &filename, CQXmlTemplate *tmpl);
+
+  bool reloadTemplate(CQXmlTemplate *tmpl);
+
+  void updateWatch();
+
+  void endBuild();
+
+  void clearWidgets();
+
+  bool reloadRoot(CQXmlReloadState &state, CQXmlTag *otag, CQXmlTag *ntag);
+
+  bool reloadChildren(CQXmlReloadState &state, CQXmlTag *otag, CQXmlTag *ntag,
+                      QWidget *widget, QLayout *layout);
+
+  bool reloadTag(CQXmlReloadState &state, CQXmlTag *ptag, CQXmlTag *otag, CQXmlTag *ntag);
+
+  void reloadBuild(CQXmlReloadState &state, CQXmlTag *ptag, CQXmlTag *tag,
+                   QWidget *widget, QLayout *layout, QObject *before);
+
+  void reloadExec(CQXmlReloadState &state, CQXmlTag *ptag, CQXmlTag *tag);
+
+  void destroyTag(CQXmlReloadState &state, CQXmlTag *tag);
+
  private:
   using LayoutMap       = std::map<QString, QLayout *>;
   using WidgetMap       = std::map<QString, QWidget *>;
   using ActionMap       = std::map<QString, QAction *>;
-  using WidgetFactories = std::map<QString, CQXmlWidgetFactory *>;
-  using TagFactories    = std::map<QString, CQXmlTagFactory *>;
-
-  CXML*           xml_     { nullptr };
-  QWidget*        parent_  { nullptr };
-  CQXmlFactory*   factory_ { nullptr };
-  LayoutMap       layouts_;
-  WidgetMap       widgets_;
-  ActionMap       actions_;
-  WidgetFactories widgetFactories_;
-  TagFactories    tagFactories_;
+  using FactoryHandles  = std::unordered_map<std::string, CQXmlFactoryHandle>;
+  using ModelFactories  = std::map<QString, CQXmlModelFactory *>;
+  using Templates       = std::map<QString, CQXmlTemplate *>;
+  using DeferredList    = std::set<CQXmlDeferred *>;
+  using TreeRefs        = std::map<CQXmlFactory *, int>;
+  using RetiredTrees    = std::map<CQXmlFactory *, CXML *>;
+  using ParseWatcher    = QFutureWatcher<CQXmlTemplate *>;
+  using AsyncLoads      = std::map<ParseWatcher *, QPointer<QWidget>>;
+
+  CXML*                  xml_                 { nullptr };
+  QWidget*               parent_              { nullptr };
+  std::string            filename_;
+  bool                   fileTree_            { false };
+  CQXmlFactory*          factory_             { nullptr };
+  CQXmlIconCache*        iconCache_           { nullptr };
+  LayoutMap              layouts_;
+  WidgetMap              widgets_;
+  ActionMap              actions_;
+  FactoryHandles         factoryHandles_;
+  mutable QReadWriteLock factoryLock_;
+  QAtomicInt             factoryGeneration_;
+  ModelFactories         modelFactories_;
+  bool                   streaming_           { false };
+  bool                   discardParseTree_    { false };
+  bool                   arenaBuild_          { false };
+  ParseMemory            parseMemory_;
+  bool                   cacheTemplates_      { false };
+  Templates              templates_;
+  CQXmlTemplate*         template_            { nullptr };
+  int                    templateCacheHits_   { 0 };
+  int                    templateCacheMisses_ { 0 };
+  bool                   lazyPages_           { false };
+  bool                   lazyDialogs_         { false };
+  bool                   lazyMenus_           { false };
+  bool                   lazyDocks_           { false };
+  bool                   batchItems_          { false };
+  bool                   lazyTreeItems_       { false };
+  CQXmlStats*            stats_               { nullptr };
+  bool                   statsEnabled_        { false };
+  CQXmlTrace*            trace_               { nullptr };
+  DeferredList           deferred_;
+  TreeRefs               treeRefs_;     // deferred records using each tag tree
+  RetiredTrees           retiredTrees_; // replaced tag trees kept for deferred records
+  bool                   watchFile_           { false };
+  int                    watchDelay_          { 200 };
+  bool                   watchPending_        { false };
+  QFileSystemWatcher*    fileWatcher_         { nullptr };
+  QTimer*                watchTimer_          { nullptr };
+  ParseWatcher*          parseWatcher_        { nullptr };
+  AsyncLoads             asyncLoads_;
+  bool                   incrementalBuild_    { false };
+  int                    buildSlice_          { 8 };
+  CQXmlFactory*          buildFactory_        { nullptr };
+  QPointer<QWidget>      buildParent_;
+  QTimer*                buildTimer_          { nullptr };
+  bool                   buildStepping_       { false };
 };
 
 #endif
@@ -66,9 +66,36 @@
 #include <QFormLayout>
 
 #include <QMetaProperty>
+#include <QIconEngine>
+#include <QXmlStreamReader>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QHash>
+#include <QAbstractItemModel>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSignalBlocker>
+#include <QSet>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QThread>
+#include <QtConcurrent>
+#include <QFutureWatcher>
+
+#include <QMutex>
+#include <QReadWriteLock>
 
 #include <iostream>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <memory_resource>
 #include <cassert>
+#include <new>
 
 namespace CQXmlUtil {
   enum LayoutType {
@@ -114,6 +141,137 @@ namespace CQXmlUtil {
     else                                return Qt::TopToolBarArea;
   }
 
+  bool isDialogName(const std::string &name) {
+    return (name == "QDialog" || name == "QMessageBox" || name == "QFileDialog" ||
+            name == "QColorDialog" || name == "QFontDialog" || name == "QPrintDialog" ||
+            name == "QProgressDialog" || name == "QWizard");
+  }
+
+  bool stringToBool(const QString &str) {
+    return (str.toLower() == "true" || str.toLower() == "yes" || str == "1");
+  }
+
+  // "<w> <h>" size
+  bool stringToSize(const QString &str, QSize &size) {
+    auto sizes = str.split(' ');
+
+    if (sizes.length() != 2)
+      return false;
+
+    size = QSize(sizes[0].toInt(), sizes[1].toInt());
+
+    return true;
+  }
+
+  // number of pages in tab widget, tool box or stacked widget (-1 if not page container)
+  int numPages(QWidget *w) {
+    if      (qobject_cast<QTabWidget *>(w))
+      return qobject_cast<QTabWidget *>(w)->count();
+    else if (qobject_cast<QToolBox *>(w))
+      return qobject_cast<QToolBox *>(w)->count();
+    else if (qobject_cast<QStackedWidget *>(w))
+      return qobject_cast<QStackedWidget *>(w)->count();
+    else
+      return -1;
+  }
+
+  QWidget *pageWidget(QWidget *w, int ind) {
+    if      (qobject_cast<QTabWidget *>(w))
+      return qobject_cast<QTabWidget *>(w)->widget(ind);
+    else if (qobject_cast<QToolBox *>(w))
+      return qobject_cast<QToolBox *>(w)->widget(ind);
+    else if (qobject_cast<QStackedWidget *>(w))
+      return qobject_cast<QStackedWidget *>(w)->widget(ind);
+    else
+      return nullptr;
+  }
+
+  int pageIndex(QWidget *w, QWidget *page) {
+    if      (qobject_cast<QTabWidget *>(w))
+      return qobject_cast<QTabWidget *>(w)->indexOf(page);
+    else if (qobject_cast<QToolBox *>(w))
+      return qobject_cast<QToolBox *>(w)->indexOf(page);
+    else if (qobject_cast<QStackedWidget *>(w))
+      return qobject_cast<QStackedWidget *>(w)->indexOf(page);
+    else
+      return -1;
+  }
+
+  // move existing page to index (keeping its text and icon)
+  void movePage(QWidget *w, QWidget *page, int ind) {
+    int ind1 = pageIndex(w, page);
+    if (ind1 < 0 || ind1 == ind) return;
+
+    if      (qobject_cast<QTabWidget *>(w)) {
+      auto *tab = qobject_cast<QTabWidget *>(w);
+
+      auto text = tab->tabText(ind1);
+      auto icon = tab->tabIcon(ind1);
+
+      tab->removeTab(ind1);
+      tab->insertTab(ind, page, icon, text);
+    }
+    else if (qobject_cast<QToolBox *>(w)) {
+      auto *toolBox = qobject_cast<QToolBox *>(w);
+
+      auto text = toolBox->itemText(ind1);
+      auto icon = toolBox->itemIcon(ind1);
+
+      toolBox->removeItem(ind1);
+      toolBox->insertItem(ind, page, icon, text);
+    }
+    else if (qobject_cast<QStackedWidget *>(w)) {
+      auto *stack = qobject_cast<QStackedWidget *>(w);
+
+      stack->removeWidget(page);
+      stack->insertWidget(ind, page);
+    }
+  }
+
+  QWidget *currentPage(QWidget *w) {
+    if      (qobject_cast<QTabWidget *>(w))
+      return qobject_cast<QTabWidget *>(w)->currentWidget();
+    else if (qobject_cast<QToolBox *>(w))
+      return qobject_cast<QToolBox *>(w)->currentWidget();
+    else if (qobject_cast<QStackedWidget *>(w))
+      return qobject_cast<QStackedWidget *>(w)->currentWidget();
+    else
+      return nullptr;
+  }
+
+  void setCurrentPage(QWidget *w, QWidget *page) {
+    if      (qobject_cast<QTabWidget *>(w))
+      qobject_cast<QTabWidget *>(w)->setCurrentWidget(page);
+    else if (qobject_cast<QToolBox *>(w))
+      qobject_cast<QToolBox *>(w)->setCurrentWidget(page);
+    else if (qobject_cast<QStackedWidget *>(w))
+      qobject_cast<QStackedWidget *>(w)->setCurrentWidget(page);
+  }
+
+  // replace page by new page (added last) at same index and delete it. Signals are
+  // only blocked while pages are moved, returns true if new page is now current
+  bool replacePage(QWidget *w, QWidget *page, QWidget *page1) {
+    QSignalBlocker blocker(w);
+
+    auto *current = currentPage(w);
+
+    movePage(w, page1, pageIndex(w, page));
+
+    delete page;
+
+    setCurrentPage(w, current == page ? page1 : current);
+
+    return (current == page);
+  }
+
+  // tell listeners of currentChanged about current page (not emitted by set as index
+  // is unchanged)
+  void emitCurrentChanged(QWidget *w) {
+    int ind = pageIndex(w, currentPage(w));
+
+    QMetaObject::invokeMethod(w, "currentChanged", Q_ARG(int, ind));
+  }
+
   QBoxLayout *newBoxLayout(QWidget *w, const QString &str) {
     return new QBoxLayout(stringToBoxLayoutDirection(str), w);
   }
@@ -146,1237 +304,7054 @@ namespace CQXmlUtil {
 
 using namespace CQXmlUtil;
 
-class CQXmlRootTag;
-
-class CQXmlFactory : public CXMLFactory {
- public:
-  CQXmlFactory(CQXml *xml) :
-   CXMLFactory(), xml_(xml) {
-  }
+// interned attribute names. Names used by the tag classes have fixed ids
+namespace CQXmlAttr {
+  enum Id : int {
+    NAME,
+    TEXT,
+    ROW,
+    COL,
+    COLUMN,
+    ICON,
+    TAB_TEXT,
+    TAB_ICON,
+    TOOL_TEXT,
+    TOOL_ICON,
+    WINDOW_ICON,
+    PIXMAP,
+    FORM_LABEL,
+    DIRECTION,
+    MARGIN,
+    SPACING,
+    STRETCH,
+    ACTION_REF,
+    MENU_REF,
+    SOURCE,
+    DEST,
+    SOURCE_SIGNAL,
+    DEST_SIGNAL,
+    DEST_SLOT,
+    PROPERTY_PATH,
+    PROPERTY_NAME,
+    PROPERTY_WIDGET,
+    DOCK_WIDGET_AREA,
+    TOOL_BAR_AREA,
+    COLUMN_LABELS,
+    ROW_LABELS,
+    MINIMUM_SIZE,
+    MINIMUM_WIDTH,
+    MINIMUM_HEIGHT,
+    MAXIMUM_SIZE,
+    MAXIMUM_WIDTH,
+    MAXIMUM_HEIGHT,
+    FIXED_SIZE,
+    FIXED_WIDTH,
+    FIXED_HEIGHT,
+    ON_CLICKED,
+    LAZY,
+    MODEL
+  };
 
-  CQXml *getXml() const { return xml_; }
+  struct Table {
+    QReadWriteLock      lock;
+    QHash<QString, int> ids;
+    std::deque<QString> names;
+
+    Table() {
+      static const char *fixedNames[] = {
+        "name", "text", "row", "col", "column", "icon", "tabText", "tabIcon", "toolText",
+        "toolIcon", "windowIcon", "pixmap", "formLabel", "direction", "margin", "spacing",
+        "stretch", "actionRef", "menuRef", "source", "dest", "sourceSignal", "destSignal",
+        "destSlot", "propertyPath", "propertyName", "propertyWidget", "dockWidgetArea",
+        "toolBarArea", "columnLabels", "rowLabels", "minimumSize", "minimumWidth",
+        "minimumHeight", "maximumSize", "maximumWidth", "maximumHeight", "fixedSize",
+        "fixedWidth", "fixedHeight", "onClicked", "lazy", "model"
+      };
+
+      for (const auto *name : fixedNames)
+        (void) add(name);
+
+      assert(names.size() == size_t(MODEL + 1));
+    }
 
-  void setRoot(CQXmlRootTag *root) { root_ = root; }
+    int add(const QString &name) {
+      int id = int(names.size());
 
-  CXMLTag *createTag(const CXML *tag, CXMLTag *parent, const std::string &name,
-                     CXMLTag::OptionArray &options) override;
+      names.push_back(name);
 
-  void createWidgets(QWidget *parent);
+      ids[name] = id;
 
-  void createWidgets(CXMLTag *tag, QLayout *layout);
-  void createWidgets(CXMLTag *tag, QWidget *widget);
+      return id;
+    }
+  };
 
- private:
-  CQXml        *xml_;
-  CQXmlRootTag *root_;
-};
+  Table &table() {
+    static Table table;
 
-class CQXmlTag : public CXMLTag {
- public:
-  CQXmlTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-           CXMLTag::OptionArray &options) :
-   CXMLTag(xml, parent, name, options) {
+    return table;
   }
 
-  virtual ~CQXmlTag() { }
-
-  CQXml *getXml() const;
+  // id for name if already interned, else -1
+  int find(const QString &name) {
+    auto &t = table();
 
-  virtual bool isRoot  () const { return false; }
-  virtual bool isLayout() const { return false; }
-  virtual bool isWidget() const { return false; }
-  virtual bool isExec  () const { return false; }
+    QReadLocker locker(&t.lock);
 
-  virtual QLayout *createLayout(QWidget *, QLayout *, CQXmlTag *) { return nullptr; }
+    auto p = t.ids.find(name);
 
-  virtual QWidget *createLayoutChild(QLayout *, CQXmlTag *) { return nullptr; }
-  virtual QWidget *createWidgetChild(QWidget *, CQXmlTag *) { return nullptr; }
+    return (p != t.ids.end() ? p.value() : -1);
+  }
 
-  virtual bool exec(QWidget *, QLayout *) { return false; }
+  // interned id for name (added if new)
+  int id(const QString &name) {
+    int id = find(name);
 
-  virtual void endLayout() { }
+    if (id >= 0)
+      return id;
 
-  virtual void handleOptions(CXMLTag::OptionArray &options) {
-    for (auto option : options) {
-      const std::string &name  = option->getName();
-      const std::string &value = option->getValue();
+    auto &t = table();
 
-      if (! handleOption(name, value))
-        nameValues_[name.c_str()] = value.c_str();
-    }
-  }
+    QWriteLocker locker(&t.lock);
 
-  bool hasNameValue(const QString &name) const {
-    return (nameValues_.find(name) != nameValues_.end());
-  }
+    // re-check, another thread may have added it since the read
+    auto p = t.ids.find(name);
 
-  QString nameValue(const QString &name) const {
-    auto p = nameValues_.find(name);
+    if (p != t.ids.end())
+      return p.value();
 
-    if (p != nameValues_.end())
-      return (*p).second;
-    else
-      return "";
+    return t.add(name);
   }
 
-  virtual bool handleOption(const std::string &, const std::string &) { return false; }
+  // names deque never moves or removes existing entries so reference stays valid
+  // after lock is released
+  const QString &name(int id) {
+    auto &t = table();
 
-  QString getText() const {
-    std::string text = CXMLTag::getText(false);
+    QReadLocker locker(&t.lock);
 
-    return (! text.length() ? nameValue("text") : QString(text.c_str()));
+    return t.names[size_t(id)];
   }
 
- protected:
-  using NameValues = std::map<QString, QString>;
-
-  NameValues nameValues_;
-};
-
-class CQXmlLayoutTag : public CQXmlTag {
- public:
-  CQXmlLayoutTag(const CXML *xml, CXMLTag *parent, CQXmlUtil::LayoutType type,
-                 const std::string &name, CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options), type_(type) {
+  // attributes whose value is an icon or pixmap file
+  bool isIcon(int id) {
+    return (id == ICON || id == TAB_ICON || id == TOOL_ICON || id == WINDOW_ICON ||
+            id == PIXMAP);
   }
 
-  bool isLayout() const override { return true; }
+  // number of ints in value of numeric attribute (1 for int, 2 for size, else 0)
+  int numInts(int id) {
+    switch (id) {
+      case ROW: case COL: case COLUMN: case MARGIN: case SPACING: case STRETCH:
+      case MINIMUM_WIDTH: case MINIMUM_HEIGHT: case MAXIMUM_WIDTH: case MAXIMUM_HEIGHT:
+      case FIXED_WIDTH: case FIXED_HEIGHT:
+        return 1;
+      case MINIMUM_SIZE: case MAXIMUM_SIZE: case FIXED_SIZE:
+        return 2;
+      default:
+        return 0;
+    }
+  }
 
-  QLayout *createLayout(QWidget *w, QLayout *l, CQXmlTag *) override {
-    layout_ = CQXmlUtil::createLayout(w, type_, nameValue("direction"));
+  // parse value of numeric attribute into ints. Returns number of ints (0 if not
+  // numeric or invalid so value is parsed again when used)
+  int parseInts(int id, const QString &value, int ints[2]) {
+    int n = numInts(id);
 
-    layout_->setMargin(0); layout_->setSpacing(0);
+    if      (n == 1) {
+      bool ok;
 
-    int margin = 2, spacing = 2;
+      ints[0] = value.toInt(&ok);
 
-    if (hasNameValue("margin" )) margin  = nameValue("margin" ).toInt();
-    if (hasNameValue("spacing")) spacing = nameValue("spacing").toInt();
+      return (ok ? 1 : 0);
+    }
+    else if (n == 2) {
+      QSize size;
 
-    layout_->setMargin(margin); layout_->setSpacing(spacing);
+      if (! CQXmlUtil::stringToSize(value, size))
+        return 0;
 
-    if (l) {
-      if      (qobject_cast<QBoxLayout *>(l))
-        qobject_cast<QBoxLayout  *>(l)->addLayout(layout_);
-      else if (qobject_cast<QGridLayout *>(l))
-        qobject_cast<QGridLayout *>(l)->addLayout(layout_, 0, 0);
-      else if (qobject_cast<QFormLayout *>(l)) {
-        auto label = nameValue("formLabel");
+      ints[0] = size.width ();
+      ints[1] = size.height();
 
-        qobject_cast<QFormLayout *>(l)->addRow(label, layout_);
-      }
-      else
-        assert(false);
+      return 2;
     }
+    else
+      return 0;
+  }
+}
 
-    if (hasNameValue("name"))
-      getXml()->addLayout(nameValue("name"), layout_);
+// times phase(s) of build when stats is non-null. next() records the current phase
+// and starts timing the next one
+class CQXmlStatsTimer {
+ public:
+  using Phase = CQXmlStats::Phase;
 
-    return layout_;
+  CQXmlStatsTimer(CQXmlStats *stats, Phase phase, const char *name="") :
+   stats_(stats), phase_(phase), name_(name) {
+    if (stats_)
+      timer_.start();
   }
 
-  bool handleOption(const std::string &name, const std::string &value) override {
-    if      (name == "columnStretch") {
-      std::vector<std::string> fields;
-
-      CStrUtil::addFields(value, fields, ",");
+ ~CQXmlStatsTimer() {
+    stop();
+  }
 
-      if (fields.size() == 2)
-        columnStretches_.push_back(IntIntPair(std::stoi(fields[0]), std::stoi(fields[1])));
-    }
-    else if (name == "rowStretch") {
-      std::vector<std::string> fields;
+  void setName(const char *name) { name_ = name; }
 
-      CStrUtil::addFields(value, fields, ",");
+  void next(Phase phase) {
+    stop();
 
-      if (fields.size() == 2)
-        rowStretches_.push_back(IntIntPair(std::stoi(fields[0]), std::stoi(fields[1])));
-    }
-    else
-      return false;
+    phase_   = phase;
+    stopped_ = false;
 
-    return true;
+    if (stats_)
+      timer_.start();
   }
 
-  void endLayout() override {
-    if      (qobject_cast<QBoxLayout *>(layout_)) {
-    }
-    else if (qobject_cast<QGridLayout *>(layout_)) {
-      auto *grid = qobject_cast<QGridLayout *>(layout_);
-
-      for (auto ipair : columnStretches_)
-        grid->setColumnStretch(ipair.first, ipair.second);
+  void stop() {
+    if (stats_ && ! stopped_)
+      stats_->add(phase_, name_, timer_.nsecsElapsed());
 
-      for (auto ipair : rowStretches_)
-        grid->setRowStretch(ipair.first, ipair.second);
-    }
-    else if (qobject_cast<QFormLayout *>(layout_)) {
-    }
-    else
-      assert(false);
+    stopped_ = true;
   }
 
  private:
-  using IntIntPair      = std::pair<int, int>;
-  using IntIntPairArray = std::vector<IntIntPair>;
-
-  CQXmlUtil::LayoutType type_;
-  QLayout*              layout_ { nullptr };
-  IntIntPairArray       columnStretches_;
-  IntIntPairArray       rowStretches_;
+  CQXmlStats*   stats_   { nullptr };
+  Phase         phase_   { Phase::PARSE };
+  const char*   name_    { nullptr };
+  QElapsedTimer timer_;
+  bool          stopped_ { false };
 };
 
-class CQXmlRootTag : public CQXmlTag {
+//------
+
+// begin/end events in Chrome trace event format
+class CQXmlTrace {
  public:
-  CQXmlRootTag(CXMLTag *parent, CQXml *xml, const std::string &name,
-               CXMLTag::OptionArray &options) :
-   CQXmlTag(xml->getXml(), parent, name, options), xml_(xml), type_(CQXmlUtil::VBoxLayout) {
-    auto *factory = xml->getFactory();
+  CQXmlTrace() {
+    timer_.start();
+  }
+
+  void begin(const QString &name, const QString &arg=QString()) {
+    addEvent('B', name, arg);
+  }
+
+  void end(const QString &name) {
+    addEvent('E', name, QString());
+  }
 
-    factory->setRoot(this);
+  bool write(const QString &filename) const {
+    QMutexLocker locker(&mutex_);
 
-    for (auto option : options) {
-      const auto &name  = option->getName();
-      const auto &value = option->getValue();
+    QJsonArray array;
+
+    for (const auto &event : events_) {
+      QJsonObject obj;
+
+      obj["name"] = event.name;
+      obj["cat" ] = "CQXml";
+      obj["ph"  ] = QString(QChar(event.ph));
+      obj["ts"  ] = double(event.nsecs)/1000.0;
+      obj["pid" ] = 1;
+      obj["tid" ] = event.tid;
+
+      if (! event.arg.isEmpty()) {
+        QJsonObject args;
+
+        args["name"] = event.arg;
 
-      if (name == "layoutType")
-        type_ = stringToLayoutType(value.c_str());
+        obj["args"] = args;
+      }
+
+      array.append(obj);
     }
-  }
 
-  bool isRoot() const override { return true; }
+    QJsonObject root;
 
-  CQXml *getXml() const { return xml_; }
+    root["traceEvents"    ] = array;
+    root["displayTimeUnit"] = "ms";
 
-  bool handleOption(const std::string &name, const std::string &value) override {
-    if (name == "windowTitle")
-      getXml()->parent()->setWindowTitle(value.c_str());
-    else
+    QFile file(filename);
+
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate))
       return false;
 
-    return true;
+    return (file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) >= 0);
   }
 
-  QLayout *createRootLayout(QWidget *parent) {
-    return CQXmlUtil::createLayout(parent, type_, nameValue("direction"));
+ private:
+  // events can be added from worker threads (each thread has own track)
+  void addEvent(char ph, const QString &name, const QString &arg) {
+    QMutexLocker locker(&mutex_);
+
+    Event event;
+
+    event.ph    = ph;
+    event.name  = name;
+    event.arg   = arg;
+    event.nsecs = timer_.nsecsElapsed();
+
+    auto p = threadIds_.find(QThread::currentThread());
+
+    if (p == threadIds_.end())
+      p = threadIds_.insert(std::make_pair(QThread::currentThread(),
+                                           int(threadIds_.size()) + 1)).first;
+
+    event.tid = (*p).second;
+
+    events_.push_back(event);
   }
 
  private:
-  CQXml*                xml_ { nullptr };
-  CQXmlUtil::LayoutType type_;
+  struct Event {
+    char    ph    { 'B' };
+    QString name;
+    QString arg;
+    qint64  nsecs { 0 };
+    int     tid   { 1 };
+  };
+
+  using Events    = std::vector<Event>;
+  using ThreadIds = std::map<QThread *, int>;
+
+  mutable QMutex mutex_;
+  QElapsedTimer  timer_;
+  Events         events_;
+  ThreadIds      threadIds_;
 };
 
-class CQXmlStyleTag : public CQXmlTag {
+// trace begin/end event pair for scope (does nothing if trace is null)
+class CQXmlTraceScope {
  public:
-  CQXmlStyleTag(const CXML *xml, CXMLTag *parent, const std::string &style,
-                const std::string &name, CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options), style_(style) {
-  }
+  CQXmlTraceScope(CQXmlTrace *trace, const char *name, const QString &arg=QString()) :
+   trace_(trace) {
+    if (trace_) {
+      name_ = name;
 
-  bool isWidget() const override { return true; }
+      trace_->begin(name_, arg);
+    }
+  }
 
-  QWidget *createLayoutChild(QLayout *l, CQXmlTag *) override {
-    return CQStyleWidgetMgrInst->addStyleLabel(l, getText(), style_.c_str());
+ ~CQXmlTraceScope() {
+    if (trace_)
+      trace_->end(name_);
   }
 
  private:
-  std::string style_;
+  CQXmlTrace* trace_ { nullptr };
+  QString     name_;
 };
 
-class CQXmlLayoutItemTag : public CQXmlTag {
+//------
+
+class CQXmlRootTag;
+class CQXmlItemStore;
+class CQXmlTreeWidgetItem;
+
+class CQXmlFactory : public CXMLFactory {
  public:
-  CQXmlLayoutItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                     CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
+  CQXmlFactory(CQXml *xml) :
+   CXMLFactory(), xml_(xml) {
   }
 
-  bool isLayout() const override { return true; }
+ ~CQXmlFactory() {
+    cancelBuild();
+  }
 
-  QLayout *createLayout(QWidget *, QLayout *l, CQXmlTag *) override {
-    if      (qobject_cast<QBoxLayout *>(l)) {
-      if (hasNameValue("spacing"))
-        qobject_cast<QBoxLayout *>(l)->addSpacing(nameValue("spacing").toInt());
+  CQXml *getXml() const { return xml_; }
 
-      if (hasNameValue("stretch"))
-        qobject_cast<QBoxLayout *>(l)->addStretch(nameValue("stretch").toInt());
-    }
+  CQXmlRootTag *root() const { return root_; }
+  void setRoot(CQXmlRootTag *root) { root_ = root; }
 
-    return l;
-  }
-};
+  // allow widget creation to be deferred (tag tree must outlive the widgets)
+  bool isDeferAllowed() const { return deferAllowed_; }
+  void setDeferAllowed(bool b) { deferAllowed_ = b; }
 
-class CQXmlComboItemTag : public CQXmlTag {
- public:
-  CQXmlComboItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                    CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
+  CXMLTag *createTag(const CXML *tag, CXMLTag *parent, const std::string &name,
+                     CXMLTag::OptionArray &options) override;
+
+  CQXmlFactoryHandle lookup(const std::string &name) const {
+    return xml_->lookupFactory(name);
   }
 
-  bool isWidget() const override { return true; }
+  // name attribute of tag for trace event (only when tracing)
+  QString traceArg(CQXmlTag *tag) const;
 
-  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
-    if (! qobject_cast<QComboBox *>(w)) return w;
+  // stats to record build timings in (null if disabled)
+  CQXmlStats *stats() const { return (xml_->isStats() ? xml_->stats() : nullptr); }
 
-    if (hasNameValue("icon")) {
-      QPixmap pixmap(nameValue("icon"));
+  CXMLTag *createTag(const CXML *tag, CXMLTag *parent, const std::string &name,
+                     CXMLTag::OptionArray &options, const CQXmlFactoryHandle &handle);
 
-      qobject_cast<QComboBox *>(w)->addItem(QIcon(pixmap), getText());
-    }
-    else
-      qobject_cast<QComboBox *>(w)->addItem(getText());
+  QLayout *initRoot(QWidget *parent);
 
-    return w;
-  }
-};
+  void createWidgets(QWidget *parent);
 
-class CQXmlListItemTag : public CQXmlTag {
- public:
-  CQXmlListItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                   CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
-  }
+  void createWidgets(CXMLTag *tag, QLayout *layout);
+  void createWidgets(CXMLTag *tag, QWidget *widget);
 
-  bool isWidget() const override { return true; }
+  void createChild(CQXmlTag *ptag, CQXmlTag *tag, QWidget *widget, QLayout *layout,
+                   QWidget *&widget1, QLayout *&layout1);
 
-  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
-    if (! qobject_cast<QListWidget *>(w)) return w;
+  void createChildWidgets(CQXmlTag *tag, QWidget *widget, QLayout *layout);
 
-    qobject_cast<QListWidget *>(w)->addItem(getText());
+  // create child items of tree item tag under item
+  void createTreeItems(CXMLTag *tag, QWidget *tree, QTreeWidgetItem *item);
 
-    return w;
-  }
-};
-
-class CQXmlTableItemTag : public CQXmlTag {
- public:
-  CQXmlTableItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                    CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
-  }
+  // incremental build started by createWidgets (see CQXml::setIncrementalBuild)
+  bool isBuilding() const { return ! buildStack_.empty(); }
 
-  bool isWidget() const override { return true; }
-
-  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
-    if (! qobject_cast<QTableWidget *>(w)) return w;
+  // create next child of incremental build (false when build is complete)
+  bool buildStep() { return buildStep(buildStack_); }
 
-    auto *item = new QTableWidgetItem(getText());
+  void finishBuild();
+  void cancelBuild();
 
-    int row = nameValue("row"   ).toInt();
-    int col = nameValue("column").toInt();
+  int numBuildTags() const { return numBuildTags_; }
+  int numBuiltTags() const { return std::min(numBuilt_, numBuildTags_); }
 
-    qobject_cast<QTableWidget *>(w)->setItem(row, col, item);
+  // item tags of widget are collected and added in one step
+  bool isItemBatch(CXMLTag *tag, QWidget *widget) const;
 
-    return w;
-  }
-};
+  void applyItems(CQXmlTag *ptag, QWidget *widget, const CQXmlItemStore &store);
 
-class CQXmlTreeItemTag : public CQXmlTag {
- public:
-  CQXmlTreeItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                   CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
-  }
+ private:
+  // tag whose children are being created (children are added to layout or widget)
+  struct BuildFrame {
+    CXMLTag*         tag       { nullptr };
+    CQXmlTag*        ptag      { nullptr };
+    QWidget*         widget    { nullptr };
+    QLayout*         layout    { nullptr };
+    bool             isLayout  { false };
+    bool             endLayout { false };   // call endLayout of tag when done
+    bool             trace     { false };   // end trace event of tag when done
+    size_t           ind       { 0 };       // next child token
+    CQXmlItemStore*  items     { nullptr }; // item tags collected for item batch
+    QTreeWidgetItem* item      { nullptr }; // parent item of tree item tags
+  };
 
-  bool isWidget() const override { return true; }
+  // explicit stack of tags (instead of recursion) so build can be split into slices
+  using BuildStack = std::vector<BuildFrame>;
 
-  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
-    if (! qobject_cast<QTreeWidget *>(w)) return w;
+  void pushWidgets(BuildStack &stack, CXMLTag *tag, QLayout *layout);
+  void pushWidgets(BuildStack &stack, CXMLTag *tag, QWidget *widget);
 
-    auto items = getText().split(' ');
+  bool pushChildWidgets(BuildStack &stack, CQXmlTag *tag, QWidget *widget, QLayout *layout);
 
-    auto *item = new QTreeWidgetItem(items);
+  bool pushTreeItems(BuildStack &stack, CQXmlTag *tag, QWidget *tree,
+                     CQXmlTreeWidgetItem *item);
 
-    qobject_cast<QTreeWidget *>(w)->addTopLevelItem(item);
+  bool buildStep(BuildStack &stack);
 
-    return w;
-  }
-};
+  void buildAll(BuildStack &stack);
 
-class CQXmlTabItemTag : public CQXmlTag {
- public:
-  CQXmlTabItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                  CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
-  }
+  void popBuild(BuildStack &stack);
 
-  bool isWidget() const override { return true; }
+  int countTags(CXMLTag *tag) const;
 
-  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
-    if (! qobject_cast<QTabBar *>(w)) return w;
+  bool isLazy(CQXmlTag *tag, bool lazy) const;
 
-    if (hasNameValue("icon")) {
-      QPixmap pixmap(nameValue("icon"));
+  bool deferPage    (CQXmlTag *ptag, CQXmlTag *tag, QWidget *widget);
+  bool deferDialog  (CQXmlTag *ptag, CQXmlTag *tag);
+  bool deferChildren(CQXmlTag *tag, QWidget *widget);
+  bool deferItems   (CQXmlTag *tag, QWidget *tree, CQXmlTreeWidgetItem *item);
 
-      qobject_cast<QTabBar *>(w)->addTab(QIcon(pixmap), getText());
-    }
-    else
-      qobject_cast<QTabBar *>(w)->addTab(getText());
+  CQXmlDeferred *addDeferred(CQXmlDeferredType type, CQXmlTag *ptag, CQXmlTag *tag,
+                             QWidget *widget);
 
-    return w;
-  }
+ private:
+  CQXml        *xml_          { nullptr };
+  CQXmlRootTag *root_         { nullptr };
+  bool          deferAllowed_ { true };
+  BuildStack    buildStack_;
+  int           numBuildTags_ { 0 };
+  int           numBuilt_     { 0 };
 };
 
-class CQXmlMenuTitleTag : public CQXmlTag {
+// monotonic arena for tags created during a build. Memory is released in one step
+// when the arena is destroyed (deletes of arena allocated tags do nothing)
+class CQXmlArena {
  public:
-  CQXmlMenuTitleTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                    CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
+  CQXmlArena(size_t initialSize=64*1024) :
+   resource_(initialSize) {
   }
 
-  bool isWidget() const override { return true; }
+  std::pmr::memory_resource *resource() { return &resource_; }
 
-  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
-    if (! qobject_cast<QMenuBar *>(w)) return w;
+  void *allocate(size_t size) {
+    return resource_.allocate(size, alignof(std::max_align_t));
+  }
 
-    auto *menu = qobject_cast<QMenuBar *>(w)->addMenu(getText());
+  // arena used by current thread (if any)
+  static CQXmlArena *current() { return current_; }
+  static void setCurrent(CQXmlArena *arena) { current_ = arena; }
 
-    return menu;
+  static std::pmr::memory_resource *currentResource() {
+    return (current_ ? current_->resource() : std::pmr::get_default_resource());
   }
+
+ private:
+  static thread_local CQXmlArena *current_;
+
+  std::pmr::monotonic_buffer_resource resource_;
 };
 
-class CQXmlActionTag : public CQXmlTag {
+thread_local CQXmlArena *CQXmlArena::current_ = nullptr;
+
+class CQXmlArenaScope {
  public:
-  CQXmlActionTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                 CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
+  CQXmlArenaScope(CQXmlArena *arena) :
+   saveArena_(CQXmlArena::current()) {
+    CQXmlArena::setCurrent(arena);
   }
 
-  bool isWidget() const override { return true; }
+ ~CQXmlArenaScope() {
+    CQXmlArena::setCurrent(saveArena_);
+  }
 
-  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
-    QAction *action = nullptr;
+ private:
+  CQXmlArena *saveArena_ { nullptr };
+};
 
-    if      (hasNameValue("actionRef"))
-      action = getXml()->getAction(nameValue("actionRef"));
-    else if (hasNameValue("icon")) {
-      QPixmap pixmap(nameValue("icon"));
+//---
 
-      action = new QAction(QIcon(pixmap), getText(), nullptr);
-    }
-    else if (getText().length())
-      action = new QAction(getText(), nullptr);
+class CQXmlTag : public CXMLTag {
+ public:
+  CQXmlTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+           CXMLTag::OptionArray &options) :
+   CXMLTag(xml, parent, name, options), nameValues_(CQXmlArena::currentResource()) {
+  }
 
-    if (! action)
-      return w;
+  virtual ~CQXmlTag() { }
 
-    if      (qobject_cast<QMenu *>(w))
-      qobject_cast<QMenu *>(w)->addAction(action);
-    else if (qobject_cast<QToolBar *>(w))
-      qobject_cast<QToolBar *>(w)->addAction(action);
+  // allocation header records arena (if any) so delete knows how to free and size
+  // of (derived) tag class for memoryBytes
+  struct AllocHeader {
+    CQXmlArena *arena { nullptr };
+    size_t      size  { 0 };
+  };
 
-    if (hasNameValue("name"))
-      getXml()->addAction(nameValue("name"), action);
+  static void *operator new(size_t size) {
+    auto *arena = CQXmlArena::current();
 
-    return w;
-  }
-};
+    auto *p = static_cast<char *>(arena ? arena->allocate(size + allocHeaderSize()) :
+                                          ::operator new(size + allocHeaderSize()));
 
-class CQXmlConnectTag : public CQXmlTag {
- public:
-  CQXmlConnectTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                  CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
-  }
+    auto *header = new (p) AllocHeader;
 
-  bool isExec() const override { return true; }
+    header->arena = arena;
+    header->size  = size;
 
-  bool exec(QWidget *, QLayout *) override {
-    QWidget *source = nullptr, *dest = nullptr;
+    return p + allocHeaderSize();
+  }
 
-    if (hasNameValue("source"))
-      source = getXml()->getWidget(nameValue("source"));
+  static void operator delete(void *ptr) {
+    if (! ptr) return;
 
-    if (hasNameValue("dest"))
-      dest = getXml()->getWidget(nameValue("dest"));
+    auto *p = static_cast<char *>(ptr) - allocHeaderSize();
 
-    auto sourceSignal = "2" + nameValue("sourceSignal");
+    if (! reinterpret_cast<AllocHeader *>(p)->arena)
+      ::operator delete(p);
+  }
 
-    if (hasNameValue("destSignal")) {
-      auto destSignal = "2" + nameValue("destSignal");
+  static size_t allocHeaderSize() {
+    const size_t align = alignof(std::max_align_t);
 
-      QObject::connect(source, sourceSignal.toLatin1(), dest, destSignal.toLatin1());
-    }
-    else {
-      auto destSlot = "1" + nameValue("destSlot");
+    return ((sizeof(AllocHeader) + align - 1)/align)*align;
+  }
 
-      QObject::connect(source, sourceSignal.toLatin1(), dest, destSlot.toLatin1());
-    }
+  // allocated size of tag object (including derived class members)
+  size_t allocSize() const {
+    auto *p = reinterpret_cast<const char *>(this) - allocHeaderSize();
 
-    return false;
+    return reinterpret_cast<const AllocHeader *>(p)->size;
   }
-};
 
-class CQXmlPropertyItemTag : public CQXmlTag {
- public:
-  CQXmlPropertyItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
-                       CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, name, options) {
-  }
+  // owning CQXml (set by factory on creation)
+  CQXml *getXml() const { return qxml_; }
+  void setXml(CQXml *qxml) { qxml_ = qxml; }
 
-  bool isExec() const override { return true; }
+  // widget or layout created for tag by last build (null if tag does not create one)
+  QObject *object() const { return object_; }
+  void setObject(QObject *object) { object_ = object; }
 
-  bool exec(QWidget *widget, QLayout *) override {
-    if (! widget) return false;
+  virtual bool isRoot  () const { return false; }
+  virtual bool isLayout() const { return false; }
+  virtual bool isWidget() const { return false; }
+  virtual bool isExec  () const { return false; }
 
-    auto propertyPath = nameValue("propertyPath");
-    auto propertyName = nameValue("propertyName");
+  virtual QLayout *createLayout(QWidget *, QLayout *, CQXmlTag *) { return nullptr; }
 
-    if (! propertyName.size())
-      return false;
+  virtual QWidget *createLayoutChild(QLayout *, CQXmlTag *) { return nullptr; }
+  virtual QWidget *createWidgetChild(QWidget *, CQXmlTag *) { return nullptr; }
 
-    auto *propertyWidget = getXml()->getWidget(nameValue("propertyWidget"));
-    if (! propertyWidget) return false;
+  virtual bool exec(QWidget *, QLayout *) { return false; }
 
-    auto *tree = qobject_cast<CQPropertyTree *>(widget);
-    if (! tree) return false;
+  virtual void endLayout() { }
 
-    tree->addProperty(propertyPath, propertyWidget, propertyName);
+  virtual void handleOptions(CXMLTag::OptionArray &options) {
+    nameValues_.reserve(nameValues_.size() + options.size());
 
-    return true;
-  }
-};
+    for (auto option : options) {
+      const std::string &name  = option->getName();
+      const std::string &value = option->getValue();
 
-class CQXmlQtWidgetTag : public CQXmlTag {
- public:
-  CQXmlQtWidgetTag(const CXML *xml, CXMLTag *parent, const std::string &type,
-                   CXMLTag::OptionArray &options) :
-   CQXmlTag(xml, parent, type, options), type_(type.c_str()) {
+      addNameValue(name.c_str(), value.c_str());
+    }
   }
 
-  bool isWidget() const override { return true; }
-
-  QWidget *createLayoutChild(QLayout *l, CQXmlTag *) override {
-    auto text = getText();
-
-    auto *w = createWidgetI(text);
+  void addNameValue(const QString &name, const QString &value) {
+    addNameValue(CQXmlAttr::id(name), name, value);
+  }
 
-    if (l && CQXmlUtil::allowLayout(w)) {
-      if      (qobject_cast<QBoxLayout *>(l))
-        qobject_cast<QBoxLayout *>(l)->addWidget(w);
-      else if (qobject_cast<QGridLayout *>(l)) {
-        int row = nameValue("row").toInt();
-        int col = nameValue("col").toInt();
+  // add value for name with interned id already looked up
+  void addNameValue(int id, const QString &name, const QString &value) {
+    if (! handleOption(name, value))
+      setNameValue(id, value);
 
-        qobject_cast<QGridLayout *>(l)->addWidget(w, row, col);
-      }
-      else if (qobject_cast<QFormLayout *>(l)) {
-        auto label = nameValue("formLabel");
+    if (CQXmlAttr::isIcon(id))
+      prefetchPixmap(value);
+  }
 
-        qobject_cast<QFormLayout *>(l)->addRow(label, w);
+  void setNameValue(int id, const QString &value) {
+    for (auto &nameValue : nameValues_) {
+      if (nameValue.id == id) {
+        nameValue.value   = value;
+        nameValue.numInts = 0;
+        return;
       }
     }
 
-    if (hasNameValue("menuRef")) {
-      auto *menu = qobject_cast<QMenu *>(getXml()->getWidget(nameValue("menuRef")));
-      if (! menu) return w;
+    nameValues_.push_back(NameValue { id, 0, { 0, 0 }, value });
+  }
 
-      if      (qobject_cast<QToolButton *>(w))
-        qobject_cast<QToolButton *>(w)->setMenu(menu);
-      else if (qobject_cast<QPushButton *>(w))
-        qobject_cast<QPushButton *>(w)->setMenu(menu);
+  // set pre-parsed ints of numeric value (from compiled form)
+  void setNameInts(int id, int numInts, const int ints[2]) {
+    for (auto &nameValue : nameValues_) {
+      if (nameValue.id == id) {
+        nameValue.numInts = numInts;
+        nameValue.ints[0] = ints[0];
+        nameValue.ints[1] = ints[1];
+        return;
+      }
     }
-
-    if (qobject_cast<QDialog *>(w) || qobject_cast<QMainWindow *>(w))
-      w->show();
-
-    return w;
   }
 
-  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
-    auto text = getText();
-
-    auto *w1 = createWidgetI(text);
+  // small flat array of (interned name id, value). Numeric values can have their
+  // ints pre-parsed (numInts is 0 if not)
+  struct NameValue {
+    int     id      { -1 };
+    int     numInts { 0 };
+    int     ints[2] { 0, 0 };
+    QString value;
+  };
 
-    if      (qobject_cast<QTabWidget *>(w)) {
-      auto text1 = nameValue("tabText");
+  using NameValues = std::pmr::vector<NameValue>;
 
-      if (hasNameValue("tabIcon")) {
-        QPixmap pixmap(nameValue("tabIcon"));
+  const NameValues &nameValues() const { return nameValues_; }
 
-        qobject_cast<QTabWidget *>(w)->addTab(w1, QIcon(pixmap), text1);
-      }
-      else
-        qobject_cast<QTabWidget *>(w)->addTab(w1, text1);
+  bool hasNameValue(int id) const {
+    for (const auto &nameValue : nameValues_) {
+      if (nameValue.id == id)
+        return true;
     }
-    else if (qobject_cast<QToolBox *>(w)) {
-      auto text1 = nameValue("toolText");
 
-      if (hasNameValue("toolIcon")) {
-        QPixmap pixmap(nameValue("toolIcon"));
+    return false;
+  }
 
-        qobject_cast<QToolBox *>(w)->addItem(w1, QIcon(pixmap), text1);
-      }
-      else
-        qobject_cast<QToolBox *>(w)->addItem(w1, text1);
-    }
-    else if (qobject_cast<QMenuBar *>(w)) {
-      if (qobject_cast<QMenu *>(w1)) {
-        qobject_cast<QMenuBar *>(w)->addMenu(qobject_cast<QMenu *>(w1));
-      }
-    }
-    else if (qobject_cast<QMenu *>(w)) {
-      if (qobject_cast<QMenu *>(w1)) {
-        qobject_cast<QMenu *>(w)->addMenu(qobject_cast<QMenu *>(w1));
-      }
-    }
-    else if (qobject_cast<QMainWindow *>(w)) {
-      if      (qobject_cast<QDockWidget *>(w1)) {
-        auto area = Qt::LeftDockWidgetArea;
+  bool hasNameValue(const QString &name) const {
+    int id = CQXmlAttr::find(name);
 
-        auto dockWidgetArea = nameValue("dockWidgetArea");
+    return (id >= 0 && hasNameValue(id));
+  }
 
-        if (dockWidgetArea.length())
-          area = CQXmlUtil::stringToDockWidgetArea(dockWidgetArea);
+  QString nameValue(int id) const {
+    for (const auto &nameValue : nameValues_) {
+      if (nameValue.id == id)
+        return nameValue.value;
+    }
 
-        qobject_cast<QMainWindow *>(w)->addDockWidget(area, qobject_cast<QDockWidget *>(w1));
-      }
-      else if (qobject_cast<QToolBar *>(w1)) {
-        auto area = Qt::TopToolBarArea;
+    return "";
+  }
 
-        auto toolBarArea = nameValue("toolBarArea");
+  QString nameValue(const QString &name) const {
+    int id = CQXmlAttr::find(name);
 
-        if (toolBarArea.length())
-          area = CQXmlUtil::stringToToolBarArea(toolBarArea);
+    return (id >= 0 ? nameValue(id) : QString());
+  }
 
-        qobject_cast<QMainWindow *>(w)->addToolBar(area, qobject_cast<QToolBar *>(w1));
-      }
-      else if (qobject_cast<QMenuBar *>(w1))
-        qobject_cast<QMainWindow *>(w)->setMenuBar(qobject_cast<QMenuBar *>(w1));
-      else if (qobject_cast<QStatusBar *>(w1))
-        qobject_cast<QMainWindow *>(w)->setStatusBar(qobject_cast<QStatusBar *>(w1));
-      else if (qobject_cast<QMdiArea *>(w1))
-        qobject_cast<QMainWindow *>(w)->setCentralWidget(qobject_cast<QMdiArea *>(w1));
-      else
-        qobject_cast<QMainWindow *>(w)->setCentralWidget(w1);
-    }
-    else if (qobject_cast<QDockWidget *>(w)) {
-      qobject_cast<QDockWidget *>(w)->setWidget(w1);
-    }
-    else if (qobject_cast<QMdiArea *>(w)) {
-      qobject_cast<QMdiArea *>(w)->addSubWindow(w1);
-    }
-    else if (qobject_cast<QMdiSubWindow *>(w)) {
-      qobject_cast<QMdiSubWindow *>(w)->setWidget(w1);
-    }
-    else if (qobject_cast<QWizard *>(w)) {
-      qobject_cast<QWizard *>(w)->addPage(qobject_cast<QWizardPage *>(w1));
+  // value of int attribute (0 if missing or invalid)
+  int intValue(int id) const {
+    for (const auto &nameValue : nameValues_) {
+      if (nameValue.id == id)
+        return (nameValue.numInts == 1 ? nameValue.ints[0] : nameValue.value.toInt());
     }
 
-    return w1;
+    return 0;
   }
 
- private:
-  QWidget *createWidgetI(const QString &text) {
-    auto *xml = getXml();
-
-    auto *factory = xml->getWidgetFactory(type_);
-
-    auto *w = factory->createWidget(options_);
+  // value of size attribute, returns false if missing or invalid
+  bool sizeValue(int id, QSize &size) const {
+    for (const auto &nameValue : nameValues_) {
+      if (nameValue.id != id)
+        continue;
 
-    if (hasNameValue("name")) {
-      w->setObjectName(nameValue("name"));
+      if (nameValue.numInts == 2) {
+        size = QSize(nameValue.ints[0], nameValue.ints[1]);
+        return true;
+      }
 
-      getXml()->addWidget(nameValue("name"), w);
+      return CQXmlUtil::stringToSize(nameValue.value, size);
     }
 
-    if      (qobject_cast<QLabel *>(w))
-      qobject_cast<QLabel *>(w)->setText(text);
-    else if (qobject_cast<QAbstractButton *>(w))
-      qobject_cast<QAbstractButton *>(w)->setText(text);
-    else if (qobject_cast<QLineEdit *>(w))
-      qobject_cast<QLineEdit *>(w)->setText(text);
-    else if (qobject_cast<QPlainTextEdit *>(w))
-      qobject_cast<QPlainTextEdit *>(w)->setPlainText(text);
-    else if (qobject_cast<QTextEdit *>(w))
-      qobject_cast<QTextEdit *>(w)->setText(text);
+    return false;
+  }
 
-    const auto *meta = w->metaObject();
+  virtual bool handleOption(const QString &, const QString &) { return false; }
 
-    if (meta) {
-      for (auto nameValue : nameValues_) {
-        int propIndex = meta->indexOfProperty(nameValue.first.toLatin1());
-        if (propIndex < 0) continue;
+  void prefetchPixmap(const QString &filename) const;
 
-        auto mP = meta->property(propIndex);
-        if (! mP.isWritable()) continue;
+  QPixmap loadPixmap(const QString &filename) const;
+  QPixmap loadPixmap(const QString &filename, QObject *target,
+                     const CQXmlIconCache::PixmapSetter &setter) const;
 
-        if (mP.isEnumType()) {
-          QString name(nameValue.second);
+  // approximate heap bytes used by tag and its children (tag objects, CXML name,
+  // options and text tokens and converted values). Allocator and string header
+  // overheads are not included so this is a lower bound
+  qint64 memoryBytes();
 
-          auto me = mP.enumerator();
+  // add values of name attribute of tag and its children
+  void addNames(QStringList &names);
 
-          for (int i = 0; i < me.keyCount(); ++i) {
-            if (me.key(i) == name)
-              (void) w->setProperty(nameValue.first.toLatin1(), me.value(i));
-          }
-        }
-        else {
-          QVariant v(nameValue.second);
+  // text supplied directly when tag is not part of a CXML tree (streaming)
+  void addText(const QString &text) { text_ += text; }
 
-          if      (mP.type() == QVariant::Icon) {
-            QPixmap pixmap(nameValue.second);
+  QString getText() const {
+    if (text_.length())
+      return text_;
 
-            v = QIcon(pixmap);
-          }
-          else if (mP.type() == QVariant::Pixmap) {
-            QPixmap pixmap(nameValue.second);
+    std::string text = CXMLTag::getText(false);
 
-            v = pixmap;
-          }
-          else {
-            if (! v.convert(int(mP.type())))
-              continue;
-          }
+    return (! text.length() ? nameValue(CQXmlAttr::TEXT) : QString(text.c_str()));
+  }
 
-          (void) w->setProperty(nameValue.first.toLatin1(), v);
-        }
-      }
-    }
+ protected:
+  CQXml*            qxml_ { nullptr };
+  NameValues        nameValues_;
+  QString           text_;
+  QPointer<QObject> object_;
+};
 
-    if      (qobject_cast<QTableWidget *>(w)) {
-      auto columnLabels = nameValue("columnLabels").split(' ');
+class CQXmlLayoutTag : public CQXmlTag {
+ public:
+  CQXmlLayoutTag(const CXML *xml, CXMLTag *parent, CQXmlUtil::LayoutType type,
+                 const std::string &name, CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options), type_(type) {
+  }
 
-      if (columnLabels.length())
-        qobject_cast<QTableWidget *>(w)->setHorizontalHeaderLabels(columnLabels);
+  bool isLayout() const override { return true; }
 
-      auto rowLabels = nameValue("rowLabels").split(' ');
+  using IntIntPair      = std::pair<int, int>;
+  using IntIntPairArray = std::vector<IntIntPair>;
 
-      if (rowLabels.length())
-        qobject_cast<QTableWidget *>(w)->setVerticalHeaderLabels(rowLabels);
-    }
-    else if (qobject_cast<QTreeWidget *>(w)) {
-      auto columnLabels = nameValue("columnLabels").split(' ');
+  CQXmlUtil::LayoutType type() const { return type_; }
 
-      if (columnLabels.length())
-        qobject_cast<QTreeWidget *>(w)->setHeaderLabels(columnLabels);
-    }
+  const IntIntPairArray &columnStretches() const { return columnStretches_; }
+  const IntIntPairArray &rowStretches   () const { return rowStretches_   ; }
 
-    if (hasNameValue("minimumSize")) {
-      auto sizes = nameValue("minimumSize").split(' ');
+  QLayout *layout() const { return layout_; }
+  void setLayout(QLayout *l) { layout_ = l; object_ = l; }
 
-      if (sizes.length() == 2) {
-        int w1 = sizes[0].toInt();
-        int w2 = sizes[1].toInt();
+  QLayout *createLayout(QWidget *w, QLayout *l, CQXmlTag *) override {
+    layout_ = CQXmlUtil::createLayout(w, type_, nameValue(CQXmlAttr::DIRECTION));
 
-        w->setMinimumSize(QSize(w1, w2));
-      }
-    }
-    if (hasNameValue("minimumWidth")) {
-      int w1 = nameValue("minimumWidth").toInt();
+    object_ = layout_;
 
-      w->setMinimumWidth(w1);
-    }
-    if (hasNameValue("maximumHeight")) {
-      int h1 = nameValue("maximumHeight").toInt();
+    layout_->setMargin(0); layout_->setSpacing(0);
 
-      w->setMinimumHeight(h1);
-    }
-    if (hasNameValue("maximumSize")) {
-      auto sizes = nameValue("maximumSize").split(' ');
+    int margin = 2, spacing = 2;
+
+    if (hasNameValue(CQXmlAttr::MARGIN )) margin  = intValue(CQXmlAttr::MARGIN );
+    if (hasNameValue(CQXmlAttr::SPACING)) spacing = intValue(CQXmlAttr::SPACING);
+
+    layout_->setMargin(margin); layout_->setSpacing(spacing);
 
-      if (sizes.length() == 2) {
-        int h1 = sizes[0].toInt();
-        int h2 = sizes[1].toInt();
+    if (l) {
+      if      (qobject_cast<QBoxLayout *>(l))
+        qobject_cast<QBoxLayout  *>(l)->addLayout(layout_);
+      else if (qobject_cast<QGridLayout *>(l))
+        qobject_cast<QGridLayout *>(l)->addLayout(layout_, 0, 0);
+      else if (qobject_cast<QFormLayout *>(l)) {
+        auto label = nameValue(CQXmlAttr::FORM_LABEL);
 
-        w->setMaximumSize(QSize(h1, h2));
+        qobject_cast<QFormLayout *>(l)->addRow(label, layout_);
       }
+      else
+        assert(false);
     }
-    if (hasNameValue("maximumWidth")) {
-      int w1 = nameValue("manimumWidth").toInt();
 
-      w->setMaximumWidth(w1);
+    if (hasNameValue(CQXmlAttr::NAME))
+      getXml()->addLayout(nameValue(CQXmlAttr::NAME), layout_);
+
+    return layout_;
+  }
+
+  bool handleOption(const QString &name, const QString &value) override {
+    if      (name == "columnStretch") {
+      auto fields = value.split(',');
+
+      if (fields.size() == 2)
+        columnStretches_.push_back(IntIntPair(fields[0].toInt(), fields[1].toInt()));
     }
-    if (hasNameValue("maximumHeight")) {
-      int h1 = nameValue("manimumHeight").toInt();
+    else if (name == "rowStretch") {
+      auto fields = value.split(',');
 
-      w->setMaximumHeight(h1);
+      if (fields.size() == 2)
+        rowStretches_.push_back(IntIntPair(fields[0].toInt(), fields[1].toInt()));
     }
-    if (hasNameValue("fixedSize")) {
-      auto sizes = nameValue("fixedSize").split(' ');
+    else
+      return false;
 
-      if (sizes.length() == 2) {
-        int w1 = sizes[0].toInt();
-        int h1 = sizes[1].toInt();
+    return true;
+  }
 
-        w->setMinimumWidth (w1); w->setMaximumWidth (w1);
-        w->setMinimumHeight(h1); w->setMaximumHeight(h1);
-      }
+  void endLayout() override {
+    if      (qobject_cast<QBoxLayout *>(layout_)) {
     }
-    if (hasNameValue("fixedWidth")) {
-      int w1 = nameValue("fixedWidth").toInt();
+    else if (qobject_cast<QGridLayout *>(layout_)) {
+      auto *grid = qobject_cast<QGridLayout *>(layout_);
 
-      w->setMinimumWidth(w1); w->setMaximumWidth(w1);
-    }
-    if (hasNameValue("fixedHeight")) {
-      int h1 = nameValue("fixedHeight").toInt();
+      for (auto ipair : columnStretches_)
+        grid->setColumnStretch(ipair.first, ipair.second);
 
-      w->setMinimumHeight(h1); w->setMaximumHeight(h1);
+      for (auto ipair : rowStretches_)
+        grid->setRowStretch(ipair.first, ipair.second);
     }
-    if (hasNameValue("onClicked")) {
-      auto value = nameValue("onClicked");
-      w->setProperty("onValue", value);
-      QObject::connect(w, SIGNAL(clicked()), xml, SLOT(onSlot()));
+    else if (qobject_cast<QFormLayout *>(layout_)) {
     }
-
-    return w;
+    else
+      assert(false);
   }
 
  private:
-  QString     type_;
-  QStringList options_;
+  CQXmlUtil::LayoutType type_;
+  QLayout*              layout_ { nullptr };
+  IntIntPairArray       columnStretches_;
+  IntIntPairArray       rowStretches_;
 };
 
-class CQXmlLayoutTagFactory : public CQXmlTagFactory {
+class CQXmlRootTag : public CQXmlTag {
  public:
-  CQXmlLayoutTagFactory(CQXmlUtil::LayoutType type) :
-   type_(type) {
+  CQXmlRootTag(CXMLTag *parent, CQXml *xml, const std::string &name,
+               CXMLTag::OptionArray &options) :
+   CQXmlTag(xml->getXml(), parent, name, options), type_(CQXmlUtil::VBoxLayout) {
+    setXml(xml);
   }
 
-  CQXmlTag *createTag(const CXML *tag, CXMLTag *parent, const std::string &name,
-                      CXMLTag::OptionArray &options) override {
-    return new CQXmlLayoutTag(tag, parent, type_, name, options);
+  bool isRoot() const override { return true; }
+
+  CQXmlUtil::LayoutType type() const { return type_; }
+
+  const QString &windowTitle() const { return windowTitle_; }
+
+  bool handleOption(const QString &name, const QString &value) override {
+    if      (name == "windowTitle")
+      windowTitle_ = value;
+    else if (name == "layoutType") {
+      type_ = stringToLayoutType(value);
+
+      return false;
+    }
+    else
+      return false;
+
+    return true;
+  }
+
+  void initParent(QWidget *parent) {
+    if (! windowTitle_.isNull())
+      parent->setWindowTitle(windowTitle_);
+  }
+
+  QLayout *createRootLayout(QWidget *parent) {
+    return CQXmlUtil::createLayout(parent, type_, nameValue(CQXmlAttr::DIRECTION));
   }
 
  private:
   CQXmlUtil::LayoutType type_;
+  QString               windowTitle_;
 };
 
-class CQXmlStyleTagFactory : public CQXmlTagFactory {
+class CQXmlStyleTag : public CQXmlTag {
  public:
-  CQXmlStyleTagFactory(const std::string &style) :
-   style_(style) {
+  CQXmlStyleTag(const CXML *xml, CXMLTag *parent, const std::string &style,
+                const std::string &name, CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options), style_(style) {
   }
 
-  CQXmlTag *createTag(const CXML *tag, CXMLTag *parent, const std::string &name,
-                      CXMLTag::OptionArray &options) override {
-    return new CQXmlStyleTag(tag, parent, style_, name, options);
+  bool isWidget() const override { return true; }
+
+  const std::string &style() const { return style_; }
+
+  QWidget *createLayoutChild(QLayout *l, CQXmlTag *) override {
+    QWidget *w = CQStyleWidgetMgrInst->addStyleLabel(l, getText(), style_.c_str());
+
+    object_ = w;
+
+    return w;
   }
 
  private:
   std::string style_;
 };
 
-//------
+class CQXmlLayoutItemTag : public CQXmlTag {
+ public:
+  CQXmlLayoutItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                     CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options) {
+  }
 
-CQXml::
-CQXml() :
- parent_(nullptr)
-{
-  xml_ = new CXML;
+  bool isLayout() const override { return true; }
 
-  factory_ = new CQXmlFactory(this);
+  QLayout *createLayout(QWidget *, QLayout *l, CQXmlTag *) override {
+    if      (qobject_cast<QBoxLayout *>(l)) {
+      if (hasNameValue(CQXmlAttr::SPACING))
+        qobject_cast<QBoxLayout *>(l)->addSpacing(intValue(CQXmlAttr::SPACING));
 
-  xml_->setFactory(factory_);
+      if (hasNameValue(CQXmlAttr::STRETCH))
+        qobject_cast<QBoxLayout *>(l)->addStretch(intValue(CQXmlAttr::STRETCH));
+    }
 
-  CQXmlAddWidgetFactoryT(this, QCalendarWidget);
-  CQXmlAddWidgetFactoryT(this, QCheckBox);
-  CQXmlAddWidgetFactoryT(this, QColorDialog);
-  CQXmlAddWidgetFactoryT(this, QComboBox);
-  CQXmlAddWidgetFactoryT(this, QDial);
-  CQXmlAddWidgetFactoryT(this, QDialog);
-  CQXmlAddWidgetFactoryT(this, QDateEdit);
-  CQXmlAddWidgetFactoryT(this, QDateTimeEdit);
-  CQXmlAddWidgetFactoryT(this, QDockWidget);
-  CQXmlAddWidgetFactoryT(this, QDoubleSpinBox);
-  CQXmlAddWidgetFactoryT(this, QFileDialog);
-  CQXmlAddWidgetFactoryT(this, QFontComboBox);
-  CQXmlAddWidgetFactoryT(this, QFontDialog);
-  CQXmlAddWidgetFactoryT(this, QFrame);
-  CQXmlAddWidgetFactoryT(this, QGroupBox);
-  CQXmlAddWidgetFactoryT(this, QLabel);
-  CQXmlAddWidgetFactoryT(this, QLCDNumber);
-  CQXmlAddWidgetFactoryT(this, QLineEdit);
-  CQXmlAddWidgetFactoryT(this, QListView);
-  CQXmlAddWidgetFactoryT(this, QListWidget);
-  CQXmlAddWidgetFactoryT(this, QMainWindow);
-  CQXmlAddWidgetFactoryT(this, QMdiArea);
-  CQXmlAddWidgetFactoryT(this, QMdiSubWindow);
-  CQXmlAddWidgetFactoryT(this, QMenu);
-  CQXmlAddWidgetFactoryT(this, QMenuBar);
-  CQXmlAddWidgetFactoryT(this, QMessageBox);
-  CQXmlAddWidgetFactoryT(this, QPlainTextEdit);
-#ifdef PRINT_SUPPORT
-  CQXmlAddWidgetFactoryT(this, QPrintDialog);
-#endif
-  CQXmlAddWidgetFactoryT(this, QProgressBar);
-  CQXmlAddWidgetFactoryT(this, QProgressDialog);
-  CQXmlAddWidgetFactoryT(this, QPushButton);
-  CQXmlAddWidgetFactoryT(this, QRadioButton);
-  CQXmlAddWidgetFactoryT(this, QScrollArea);
-  CQXmlAddWidgetFactoryT(this, QScrollBar);
-  CQXmlAddWidgetFactoryT(this, QSlider);
-  CQXmlAddWidgetFactoryT(this, QSpinBox);
-  CQXmlAddWidgetFactoryT(this, QSplitter);
-  CQXmlAddWidgetFactoryT(this, QStackedWidget);
-  CQXmlAddWidgetFactoryT(this, QStatusBar);
-  CQXmlAddWidgetFactoryT(this, QTabBar);
-  CQXmlAddWidgetFactoryT(this, QTabWidget);
-  CQXmlAddWidgetFactoryT(this, QTableView);
-  CQXmlAddWidgetFactoryT(this, QTableWidget);
-  CQXmlAddWidgetFactoryT(this, QTextEdit);
-  CQXmlAddWidgetFactoryT(this, QToolBar);
-  CQXmlAddWidgetFactoryT(this, QToolBox);
-  CQXmlAddWidgetFactoryT(this, QToolButton);
-  CQXmlAddWidgetFactoryT(this, QTreeView);
-  CQXmlAddWidgetFactoryT(this, QTreeWidget);
-  CQXmlAddWidgetFactoryT(this, QUndoView);
-  CQXmlAddWidgetFactoryT(this, QWidget);
-#ifdef WEBVIEW_SUPPORT
-  CQXmlAddWidgetFactoryT(this, QWebView);
-#endif
-  CQXmlAddWidgetFactoryT(this, QWizard);
-  CQXmlAddWidgetFactoryT(this, QWizardPage);
+    return l;
+  }
+};
 
-  CQXmlAddWidgetFactoryT(this, CQPropertyTree);
-  CQXmlAddTagFactoryT(this, "CQPropertyItem", CQXmlPropertyItemTag);
+class CQXmlComboItemTag : public CQXmlTag {
+ public:
+  CQXmlComboItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                    CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options) {
+  }
 
-  CQXmlAddTagFactoryT(this, "QLayoutItem", CQXmlLayoutItemTag);
-  CQXmlAddTagFactoryT(this, "QComboItem" , CQXmlComboItemTag );
-  CQXmlAddTagFactoryT(this, "QListItem"  , CQXmlListItemTag  );
-  CQXmlAddTagFactoryT(this, "QTableItem" , CQXmlTableItemTag );
-  CQXmlAddTagFactoryT(this, "QTreeItem"  , CQXmlTreeItemTag  );
-  CQXmlAddTagFactoryT(this, "QTabItem"   , CQXmlTabItemTag   );
-  CQXmlAddTagFactoryT(this, "QMenuTitle" , CQXmlMenuTitleTag );
-  CQXmlAddTagFactoryT(this, "QAction"    , CQXmlActionTag    );
+  bool isWidget() const override { return true; }
+
+  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
+    auto *combo = qobject_cast<QComboBox *>(w);
+    if (! combo) return w;
+
+    if (hasNameValue(CQXmlAttr::ICON)) {
+      combo->addItem(getText());
+
+      int ind = combo->count() - 1;
+
+      // items can be inserted or removed before icon is decoded
+      QPersistentModelIndex index(combo->model()->index(ind, combo->modelColumn()));
+
+      auto pixmap = loadPixmap(nameValue(CQXmlAttr::ICON), combo, [combo, index](const QPixmap &pixmap) {
+        if (index.isValid())
+          combo->setItemIcon(index.row(), QIcon(pixmap));
+      });
+
+      combo->setItemIcon(ind, QIcon(pixmap));
+    }
+    else
+      combo->addItem(getText());
+
+    return w;
+  }
+};
+
+// item texts stored by column (null string for unset cell)
+class CQXmlItemStore {
+ public:
+  CQXmlItemStore() { }
+
+  int numRows   () const { return numRows_; }
+  int numColumns() const { return int(columns_.size()); }
+
+  void addRow(const QStringList &values) {
+    int row = numRows_;
+
+    for (int col = 0; col < values.length(); ++col)
+      setCell(row, col, values[col]);
+
+    numRows_ = row + 1;
+  }
+
+  void setCell(int row, int col, const QString &text) {
+    if (row < 0 || col < 0) return;
+
+    if (col >= numColumns())
+      columns_.resize(size_t(col + 1));
+
+    auto &column = columns_[size_t(col)];
+
+    if (row >= int(column.size()))
+      column.resize(size_t(row + 1));
+
+    column[size_t(row)] = text;
+
+    numRows_ = std::max(numRows_, row + 1);
+  }
+
+  const QString &cell(int row, int col) const {
+    static QString noText;
+
+    if (col < 0 || col >= numColumns())
+      return noText;
+
+    const auto &column = columns_[size_t(col)];
+
+    if (row < 0 || row >= int(column.size()))
+      return noText;
+
+    return column[size_t(row)];
+  }
+
+ private:
+  using Column  = std::vector<QString>;
+  using Columns = std::vector<Column>;
+
+  Columns columns_;
+  int     numRows_ { 0 };
+};
+
+// read-only table model over item store (used for item tags in plain item views)
+class CQXmlItemModel : public QAbstractItemModel {
+ public:
+  CQXmlItemModel(QObject *parent, const CQXmlItemStore &store, const QStringList &columnLabels,
+                 const QStringList &rowLabels) :
+   QAbstractItemModel(parent), store_(store), columnLabels_(columnLabels),
+   rowLabels_(rowLabels) {
+  }
+
+  int rowCount(const QModelIndex &parent=QModelIndex()) const override {
+    if (parent.isValid()) return 0;
+
+    return store_.numRows();
+  }
+
+  int columnCount(const QModelIndex &parent=QModelIndex()) const override {
+    if (parent.isValid()) return 0;
+
+    return std::max(store_.numColumns(), int(columnLabels_.length()));
+  }
+
+  QModelIndex index(int row, int column, const QModelIndex &parent=QModelIndex()) const override {
+    if (parent.isValid() || ! hasIndex(row, column, parent))
+      return QModelIndex();
+
+    return createIndex(row, column);
+  }
+
+  QModelIndex parent(const QModelIndex &) const override {
+    return QModelIndex();
+  }
+
+  QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override {
+    if (! index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+      return QVariant();
+
+    const auto &text = store_.cell(index.row(), index.column());
+
+    if (text.isNull())
+      return QVariant();
+
+    return text;
+  }
+
+  QVariant headerData(int section, Qt::Orientation orient,
+                      int role=Qt::DisplayRole) const override {
+    const auto &labels = (orient == Qt::Horizontal ? columnLabels_ : rowLabels_);
+
+    if (role == Qt::DisplayRole && section >= 0 && section < labels.length())
+      return labels[section];
+
+    return QAbstractItemModel::headerData(section, orient, role);
+  }
+
+  Qt::ItemFlags flags(const QModelIndex &index) const override {
+    if (! index.isValid())
+      return Qt::NoItemFlags;
+
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+  }
+
+ private:
+  CQXmlItemStore store_;
+  QStringList    columnLabels_;
+  QStringList    rowLabels_;
+};
+
+// read-only model over CSV file (first line is column header). Rows are indexed in
+// chunks as the view asks for more and only row start offsets and a small cache of
+// split rows are kept in memory (file contents are memory mapped)
+class CQXmlCsvModel : public QAbstractItemModel {
+ public:
+  CQXmlCsvModel(QObject *parent, const QString &filename) :
+   QAbstractItemModel(parent), file_(filename) {
+    if (! file_.open(QIODevice::ReadOnly)) {
+      std::cerr << "Failed to open '" << filename.toStdString() << "'" << std::endl;
+      return;
+    }
+
+    size_ = file_.size();
+
+    if (size_ > 0)
+      data_ = file_.map(0, size_);
+
+    if (! data_) {
+      size_ = 0;
+      return;
+    }
+
+    pos_ = parseRow(0, &header_);
+  }
+
+ ~CQXmlCsvModel() {
+    if (data_)
+      file_.unmap(data_);
+  }
+
+  int rowCount(const QModelIndex &parent=QModelIndex()) const override {
+    if (parent.isValid()) return 0;
+
+    return int(rows_.size());
+  }
+
+  int columnCount(const QModelIndex &parent=QModelIndex()) const override {
+    if (parent.isValid()) return 0;
+
+    return int(header_.length());
+  }
+
+  bool canFetchMore(const QModelIndex &parent) const override {
+    if (parent.isValid()) return false;
+
+    return (pos_ < size_);
+  }
+
+  void fetchMore(const QModelIndex &parent) override {
+    if (parent.isValid()) return;
+
+    std::vector<qint64> rows;
+
+    while (pos_ < size_ && int(rows.size()) < fetchSize_) {
+      rows.push_back(pos_);
+
+      pos_ = parseRow(pos_, nullptr);
+    }
+
+    if (rows.empty())
+      return;
+
+    int nr = int(rows_.size());
+
+    beginInsertRows(QModelIndex(), nr, nr + int(rows.size()) - 1);
+
+    rows_.insert(rows_.end(), rows.begin(), rows.end());
+
+    endInsertRows();
+  }
+
+  QModelIndex index(int row, int column, const QModelIndex &parent=QModelIndex()) const override {
+    if (parent.isValid() || ! hasIndex(row, column, parent))
+      return QModelIndex();
+
+    return createIndex(row, column);
+  }
+
+  QModelIndex parent(const QModelIndex &) const override {
+    return QModelIndex();
+  }
+
+  QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override {
+    if (! index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+      return QVariant();
+
+    const auto &fields = rowFields(index.row());
+
+    if (index.column() >= fields.length())
+      return QVariant();
+
+    return fields[index.column()];
+  }
+
+  QVariant headerData(int section, Qt::Orientation orient,
+                      int role=Qt::DisplayRole) const override {
+    if (orient == Qt::Horizontal && role == Qt::DisplayRole &&
+        section >= 0 && section < header_.length())
+      return header_[section];
+
+    return QAbstractItemModel::headerData(section, orient, role);
+  }
+
+  Qt::ItemFlags flags(const QModelIndex &index) const override {
+    if (! index.isValid())
+      return Qt::NoItemFlags;
+
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+  }
+
+ private:
+  const QStringList &rowFields(int row) const {
+    auto p = cache_.find(row);
+
+    if (p != cache_.end())
+      return p.value();
+
+    if (cache_.size() >= maxCache_)
+      cache_.clear();
+
+    QStringList fields;
+
+    (void) parseRow(rows_[size_t(row)], &fields);
+
+    return cache_.insert(row, fields).value();
+  }
+
+  // parse row starting at pos (quoted fields can contain separators and newlines)
+  // and return start of next row (fields are only split out if fields is non-null)
+  qint64 parseRow(qint64 pos, QStringList *fields) const {
+    QByteArray field;
+
+    bool quoted = false;
+
+    while (pos < size_) {
+      char c = char(data_[pos++]);
+
+      if (quoted) {
+        if (c == '"') {
+          if (pos < size_ && data_[pos] == '"') {
+            if (fields) field += '"';
+
+            ++pos;
+          }
+          else
+            quoted = false;
+        }
+        else if (fields)
+          field += c;
+      }
+      else if (c == '"')
+        quoted = true;
+      else if (c == ',') {
+        if (fields)
+          *fields << QString::fromUtf8(field);
+
+        field.clear();
+      }
+      else if (c == '\n')
+        break;
+      else if (c != '\r' && fields)
+        field += c;
+    }
+
+    if (fields)
+      *fields << QString::fromUtf8(field);
+
+    return pos;
+  }
+
+ private:
+  using Rows  = std::vector<qint64>;
+  using Cache = QHash<int, QStringList>;
+
+  QFile         file_;
+  uchar*        data_      { nullptr };
+  qint64        size_      { 0 };
+  qint64        pos_       { 0 };
+  QStringList   header_;
+  Rows          rows_;
+  mutable Cache cache_;
+  int           fetchSize_ { 256 };
+  int           maxCache_  { 1024 };
+};
+
+class CQXmlCsvModelFactory : public CQXmlModelFactory {
+ public:
+  CQXmlCsvModelFactory(CQXml *xml) :
+   xml_(xml) {
+  }
+
+  QAbstractItemModel *createModel(const QString &source, QObject *parent) override {
+    return new CQXmlCsvModel(parent, xml_->filePath(source));
+  }
+
+ private:
+  CQXml *xml_ { nullptr };
+};
+
+// base class for item tags which can be added to an item store and applied in bulk
+class CQXmlItemTag : public CQXmlTag {
+ public:
+  CQXmlItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+               CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options) {
+  }
+
+  bool isWidget() const override { return true; }
+
+  virtual void addItem(CQXmlItemStore &store) = 0;
+};
+
+class CQXmlListItemTag : public CQXmlItemTag {
+ public:
+  CQXmlListItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                   CXMLTag::OptionArray &options) :
+   CQXmlItemTag(xml, parent, name, options) {
+  }
+
+  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
+    if (! qobject_cast<QListWidget *>(w)) return w;
+
+    qobject_cast<QListWidget *>(w)->addItem(getText());
+
+    return w;
+  }
+
+  void addItem(CQXmlItemStore &store) override {
+    store.addRow(QStringList() << getText());
+  }
+};
+
+class CQXmlTableItemTag : public CQXmlItemTag {
+ public:
+  CQXmlTableItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                    CXMLTag::OptionArray &options) :
+   CQXmlItemTag(xml, parent, name, options) {
+  }
+
+  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
+    if (! qobject_cast<QTableWidget *>(w)) return w;
+
+    auto *item = new QTableWidgetItem(getText());
+
+    int row = intValue(CQXmlAttr::ROW   );
+    int col = intValue(CQXmlAttr::COLUMN);
+
+    qobject_cast<QTableWidget *>(w)->setItem(row, col, item);
+
+    return w;
+  }
+
+  void addItem(CQXmlItemStore &store) override {
+    int row = intValue(CQXmlAttr::ROW   );
+    int col = intValue(CQXmlAttr::COLUMN);
+
+    store.setCell(row, col, getText());
+  }
+};
+
+// tree widget item which records the creation of its deferred children
+class CQXmlTreeWidgetItem : public QTreeWidgetItem {
+ public:
+  CQXmlTreeWidgetItem(const QStringList &strings) :
+   QTreeWidgetItem(strings) {
+  }
+
+ ~CQXmlTreeWidgetItem();
+
+  CQXmlDeferred *deferred() const { return deferred_; }
+  void setDeferred(CQXmlDeferred *deferred) { deferred_ = deferred; }
+
+ private:
+  CQXmlDeferred *deferred_ { nullptr };
+};
+
+// tree item (nested tree item tags are added as child items). The parent item is
+// passed by the build (not kept in tag as tag tree can be instantiated more than once)
+class CQXmlTreeItemTag : public CQXmlItemTag {
+ public:
+  CQXmlTreeItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                   CXMLTag::OptionArray &options) :
+   CQXmlItemTag(xml, parent, name, options) {
+  }
+
+  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
+    if (qobject_cast<QTreeWidget *>(w))
+      (void) addTreeItem(qobject_cast<QTreeWidget *>(w), nullptr);
+
+    return w;
+  }
+
+  // add item to parent item (or as top level item if null)
+  CQXmlTreeWidgetItem *addTreeItem(QTreeWidget *tree, QTreeWidgetItem *parentItem) {
+    auto *item = new CQXmlTreeWidgetItem(getText().split(' '));
+
+    if (parentItem)
+      parentItem->addChild(item);
+    else
+      tree->addTopLevelItem(item);
+
+    return item;
+  }
+
+  void addItem(CQXmlItemStore &store) override {
+    store.addRow(getText().split(' '));
+  }
+};
+
+// icon of tab whose icon file is still being decoded (draws nothing but reserves
+// icon space)
+class CQXmlPendingIconEngine : public QIconEngine {
+ public:
+  void paint(QPainter *, const QRect &, QIcon::Mode, QIcon::State) override { }
+
+  QIconEngine *clone() const override { return new CQXmlPendingIconEngine; }
+};
+
+class CQXmlTabItemTag : public CQXmlTag {
+ public:
+  CQXmlTabItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                  CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options) {
+  }
+
+  bool isWidget() const override { return true; }
+
+  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
+    auto *tabBar = qobject_cast<QTabBar *>(w);
+    if (! tabBar) return w;
+
+    if (hasNameValue(CQXmlAttr::ICON)) {
+      auto filename = nameValue(CQXmlAttr::ICON);
+
+      // tabs can be moved or removed before icon is decoded so tab is found by
+      // its (unique) pending icon. Icon is not replaced if application changed it
+      auto iconKey = std::make_shared<qint64>(0);
+
+      auto pixmap = loadPixmap(filename, tabBar, [tabBar, iconKey](const QPixmap &pixmap) {
+        for (int i = 0; i < tabBar->count(); ++i) {
+          if (tabBar->tabIcon(i).cacheKey() == *iconKey)
+            tabBar->setTabIcon(i, QIcon(pixmap));
+        }
+      });
+
+      QIcon icon = (! pixmap.isNull() ? QIcon(pixmap) : QIcon(new CQXmlPendingIconEngine));
+
+      *iconKey = icon.cacheKey();
+
+      tabBar->addTab(icon, getText());
+    }
+    else
+      tabBar->addTab(getText());
+
+    return w;
+  }
+};
+
+class CQXmlMenuTitleTag : public CQXmlTag {
+ public:
+  CQXmlMenuTitleTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                    CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options) {
+  }
+
+  bool isWidget() const override { return true; }
+
+  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
+    if (! qobject_cast<QMenuBar *>(w)) return w;
+
+    auto *menu = qobject_cast<QMenuBar *>(w)->addMenu(getText());
+
+    return menu;
+  }
+};
+
+class CQXmlActionTag : public CQXmlTag {
+ public:
+  CQXmlActionTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                 CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options) {
+  }
+
+  bool isWidget() const override { return true; }
+
+  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
+    QAction *action = nullptr;
+
+    if      (hasNameValue(CQXmlAttr::ACTION_REF))
+      action = getXml()->getAction(nameValue(CQXmlAttr::ACTION_REF));
+    else if (hasNameValue(CQXmlAttr::ICON)) {
+      action = new QAction(getText(), nullptr);
+
+      auto pixmap = loadPixmap(nameValue(CQXmlAttr::ICON), action, [action](const QPixmap &pixmap) {
+        action->setIcon(QIcon(pixmap));
+      });
+
+      action->setIcon(QIcon(pixmap));
+    }
+    else if (getText().length())
+      action = new QAction(getText(), nullptr);
+
+    if (! action)
+      return w;
+
+    if      (qobject_cast<QMenu *>(w))
+      qobject_cast<QMenu *>(w)->addAction(action);
+    else if (qobject_cast<QToolBar *>(w))
+      qobject_cast<QToolBar *>(w)->addAction(action);
+
+    if (hasNameValue(CQXmlAttr::NAME))
+      getXml()->addAction(nameValue(CQXmlAttr::NAME), action);
+
+    return w;
+  }
+};
+
+class CQXmlConnectTag : public CQXmlTag {
+ public:
+  CQXmlConnectTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                  CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options) {
+  }
+
+  bool isExec() const override { return true; }
+
+  bool exec(QWidget *, QLayout *) override {
+    QWidget *source = nullptr, *dest = nullptr;
+
+    if (hasNameValue(CQXmlAttr::SOURCE))
+      source = getXml()->getWidget(nameValue(CQXmlAttr::SOURCE));
+
+    if (hasNameValue(CQXmlAttr::DEST))
+      dest = getXml()->getWidget(nameValue(CQXmlAttr::DEST));
+
+    auto sourceSignal = "2" + nameValue(CQXmlAttr::SOURCE_SIGNAL);
+
+    if (hasNameValue(CQXmlAttr::DEST_SIGNAL)) {
+      auto destSignal = "2" + nameValue(CQXmlAttr::DEST_SIGNAL);
+
+      QObject::connect(source, sourceSignal.toLatin1(), dest, destSignal.toLatin1());
+    }
+    else {
+      auto destSlot = "1" + nameValue(CQXmlAttr::DEST_SLOT);
+
+      QObject::connect(source, sourceSignal.toLatin1(), dest, destSlot.toLatin1());
+    }
+
+    return false;
+  }
+};
+
+class CQXmlPropertyItemTag : public CQXmlTag {
+ public:
+  CQXmlPropertyItemTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+                       CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, name, options) {
+  }
+
+  bool isExec() const override { return true; }
+
+  bool exec(QWidget *widget, QLayout *) override {
+    if (! widget) return false;
+
+    auto propertyPath = nameValue(CQXmlAttr::PROPERTY_PATH);
+    auto propertyName = nameValue(CQXmlAttr::PROPERTY_NAME);
+
+    if (! propertyName.size())
+      return false;
+
+    auto *propertyWidget = getXml()->getWidget(nameValue(CQXmlAttr::PROPERTY_WIDGET));
+    if (! propertyWidget) return false;
+
+    auto *tree = qobject_cast<CQPropertyTree *>(widget);
+    if (! tree) return false;
+
+    tree->addProperty(propertyPath, propertyWidget, propertyName);
+
+    return true;
+  }
+};
+
+// writable property of widget class resolved from attribute name. Cached per
+// meta object and attribute name and shared by all tags, CQXml instances and threads
+struct CQXmlPropertyPlan {
+  using EnumValues = QHash<QString, int>;
+
+  bool          valid  { false };
+  QMetaProperty prop;
+  int           type   { QVariant::Invalid };
+  bool          isEnum { false };
+  EnumValues    enumValues;
+
+  static const CQXmlPropertyPlan &get(const QMetaObject *meta, int nameId);
+};
+
+class CQXmlQtWidgetTag : public CQXmlTag {
+ public:
+  CQXmlQtWidgetTag(const CXML *xml, CXMLTag *parent, CQXmlWidgetFactory *factory,
+                   const std::string &type, CXMLTag::OptionArray &options) :
+   CQXmlTag(xml, parent, type, options), factory_(factory) {
+  }
+
+  // widget factory for tag name (looked up again if factories changed since tag
+  // was created, null if factory was removed)
+  CQXmlWidgetFactory *factory() {
+    int generation = getXml()->factoryGeneration();
+
+    if (generation != generation_) {
+      auto handle = getXml()->lookupFactory(getName());
+
+      factory_    = handle.widgetFactory;
+      generation_ = handle.generation;
+
+      // values were converted for class of old factory
+      preparedMeta_ = nullptr;
+    }
+
+    return factory_;
+  }
+
+  void setGeneration(int generation) { generation_ = generation; }
+
+  const QStringList &options() const { return options_; }
+
+  bool isWidget() const override { return true; }
+
+  QWidget *createLayoutChild(QLayout *l, CQXmlTag *) override {
+    auto text = getText();
+
+    auto *w = createWidgetI(text);
+    if (! w) return nullptr;
+
+    if (l && CQXmlUtil::allowLayout(w)) {
+      if      (qobject_cast<QBoxLayout *>(l))
+        qobject_cast<QBoxLayout *>(l)->addWidget(w);
+      else if (qobject_cast<QGridLayout *>(l)) {
+        int row = intValue(CQXmlAttr::ROW);
+        int col = intValue(CQXmlAttr::COL);
+
+        qobject_cast<QGridLayout *>(l)->addWidget(w, row, col);
+      }
+      else if (qobject_cast<QFormLayout *>(l)) {
+        auto label = nameValue(CQXmlAttr::FORM_LABEL);
+
+        qobject_cast<QFormLayout *>(l)->addRow(label, w);
+      }
+    }
+
+    if (hasNameValue(CQXmlAttr::MENU_REF)) {
+      auto *menu = qobject_cast<QMenu *>(getXml()->getWidget(nameValue(CQXmlAttr::MENU_REF)));
+      if (! menu) return w;
+
+      if      (qobject_cast<QToolButton *>(w))
+        qobject_cast<QToolButton *>(w)->setMenu(menu);
+      else if (qobject_cast<QPushButton *>(w))
+        qobject_cast<QPushButton *>(w)->setMenu(menu);
+    }
+
+    if (qobject_cast<QDialog *>(w) || qobject_cast<QMainWindow *>(w))
+      w->show();
+
+    return w;
+  }
+
+  QWidget *createWidgetChild(QWidget *w, CQXmlTag *) override {
+    auto text = getText();
+
+    auto *w1 = createWidgetI(text);
+    if (! w1) return nullptr;
+
+    if (addPage(w, w1))
+      return w1;
+
+    if      (qobject_cast<QMenuBar *>(w)) {
+      if (qobject_cast<QMenu *>(w1)) {
+        qobject_cast<QMenuBar *>(w)->addMenu(qobject_cast<QMenu *>(w1));
+      }
+    }
+    else if (qobject_cast<QMenu *>(w)) {
+      if (qobject_cast<QMenu *>(w1)) {
+        qobject_cast<QMenu *>(w)->addMenu(qobject_cast<QMenu *>(w1));
+      }
+    }
+    else if (qobject_cast<QMainWindow *>(w)) {
+      if      (qobject_cast<QDockWidget *>(w1)) {
+        auto area = Qt::LeftDockWidgetArea;
+
+        auto dockWidgetArea = nameValue(CQXmlAttr::DOCK_WIDGET_AREA);
+
+        if (dockWidgetArea.length())
+          area = CQXmlUtil::stringToDockWidgetArea(dockWidgetArea);
+
+        qobject_cast<QMainWindow *>(w)->addDockWidget(area, qobject_cast<QDockWidget *>(w1));
+      }
+      else if (qobject_cast<QToolBar *>(w1)) {
+        auto area = Qt::TopToolBarArea;
+
+        auto toolBarArea = nameValue(CQXmlAttr::TOOL_BAR_AREA);
+
+        if (toolBarArea.length())
+          area = CQXmlUtil::stringToToolBarArea(toolBarArea);
+
+        qobject_cast<QMainWindow *>(w)->addToolBar(area, qobject_cast<QToolBar *>(w1));
+      }
+      else if (qobject_cast<QMenuBar *>(w1))
+        qobject_cast<QMainWindow *>(w)->setMenuBar(qobject_cast<QMenuBar *>(w1));
+      else if (qobject_cast<QStatusBar *>(w1))
+        qobject_cast<QMainWindow *>(w)->setStatusBar(qobject_cast<QStatusBar *>(w1));
+      else if (qobject_cast<QMdiArea *>(w1))
+        qobject_cast<QMainWindow *>(w)->setCentralWidget(qobject_cast<QMdiArea *>(w1));
+      else
+        qobject_cast<QMainWindow *>(w)->setCentralWidget(w1);
+    }
+    else if (qobject_cast<QDockWidget *>(w)) {
+      qobject_cast<QDockWidget *>(w)->setWidget(w1);
+    }
+    else if (qobject_cast<QMdiArea *>(w)) {
+      qobject_cast<QMdiArea *>(w)->addSubWindow(w1);
+    }
+    else if (qobject_cast<QMdiSubWindow *>(w)) {
+      qobject_cast<QMdiSubWindow *>(w)->setWidget(w1);
+    }
+    else if (qobject_cast<QWizard *>(w)) {
+      qobject_cast<QWizard *>(w)->addPage(qobject_cast<QWizardPage *>(w1));
+    }
+
+    return w1;
+  }
+
+  // create deferred dialog (not added to layout)
+  QWidget *createDialog() {
+    return createWidgetI(getText());
+  }
+
+  // add page widget to tab widget, tool box or stacked widget
+  bool addPage(QWidget *w, QWidget *w1) {
+    if      (qobject_cast<QTabWidget *>(w)) {
+      auto *tab = qobject_cast<QTabWidget *>(w);
+
+      auto text1 = nameValue(CQXmlAttr::TAB_TEXT);
+
+      if (hasNameValue(CQXmlAttr::TAB_ICON)) {
+        auto setIcon = [tab, w1](const QPixmap &pixmap) {
+          tab->setTabIcon(tab->indexOf(w1), QIcon(pixmap));
+        };
+
+        auto pixmap = loadPixmap(nameValue(CQXmlAttr::TAB_ICON), w1, setIcon);
+
+        tab->addTab(w1, QIcon(pixmap), text1);
+      }
+      else
+        tab->addTab(w1, text1);
+    }
+    else if (qobject_cast<QToolBox *>(w)) {
+      auto *toolBox = qobject_cast<QToolBox *>(w);
+
+      auto text1 = nameValue(CQXmlAttr::TOOL_TEXT);
+
+      if (hasNameValue(CQXmlAttr::TOOL_ICON)) {
+        auto setIcon = [toolBox, w1](const QPixmap &pixmap) {
+          toolBox->setItemIcon(toolBox->indexOf(w1), QIcon(pixmap));
+        };
+
+        auto pixmap = loadPixmap(nameValue(CQXmlAttr::TOOL_ICON), w1, setIcon);
+
+        toolBox->addItem(w1, QIcon(pixmap), text1);
+      }
+      else
+        toolBox->addItem(w1, text1);
+    }
+    else if (qobject_cast<QStackedWidget *>(w))
+      qobject_cast<QStackedWidget *>(w)->addWidget(w1);
+    else
+      return false;
+
+    return true;
+  }
+
+  void applyText(QWidget *w, const QString &text) {
+    if      (qobject_cast<QLabel *>(w))
+      qobject_cast<QLabel *>(w)->setText(text);
+    else if (qobject_cast<QAbstractButton *>(w))
+      qobject_cast<QAbstractButton *>(w)->setText(text);
+    else if (qobject_cast<QLineEdit *>(w))
+      qobject_cast<QLineEdit *>(w)->setText(text);
+    else if (qobject_cast<QPlainTextEdit *>(w))
+      qobject_cast<QPlainTextEdit *>(w)->setPlainText(text);
+    else if (qobject_cast<QTextEdit *>(w))
+      qobject_cast<QTextEdit *>(w)->setText(text);
+  }
+
+  // set widget property from attribute (false if not a writable property)
+  bool applyProperty(QWidget *w, const NameValue &nameValue) {
+    const auto &plan = CQXmlPropertyPlan::get(w->metaObject(), nameValue.id);
+    if (! plan.valid) return false;
+
+    if (plan.isEnum) {
+      auto p = plan.enumValues.find(nameValue.value);
+
+      if (p != plan.enumValues.end())
+        (void) plan.prop.write(w, p.value());
+    }
+    else {
+      QVariant v(nameValue.value);
+
+      if      (plan.type == QVariant::Icon) {
+        auto prop = plan.prop;
+
+        auto pixmap = loadPixmap(nameValue.value, w, [w, prop](const QPixmap &pixmap) {
+          (void) prop.write(w, QIcon(pixmap));
+        });
+
+        v = QIcon(pixmap);
+      }
+      else if (plan.type == QVariant::Pixmap) {
+        auto prop = plan.prop;
+
+        auto pixmap = loadPixmap(nameValue.value, w, [w, prop](const QPixmap &pixmap) {
+          (void) prop.write(w, pixmap);
+        });
+
+        v = pixmap;
+      }
+      else {
+        if (! v.convert(plan.type))
+          return true;
+      }
+
+      (void) plan.prop.write(w, v);
+    }
+
+    return true;
+  }
+
+  // resolve properties of widget class and convert their values ahead of widget
+  // creation (can be called from worker thread). Icon and pixmap values are added
+  // to files as they can only be converted on GUI thread
+  void prepare(QSet<QString> &files) {
+    auto *factory = this->factory();
+    if (! factory) return;
+
+    preparedMeta_ = factory->metaObject();
+    if (! preparedMeta_) return;
+
+    preparedValues_.clear();
+    preparedValues_.resize(nameValues_.size());
+
+    for (size_t i = 0; i < nameValues_.size(); ++i) {
+      const auto &nameValue = nameValues_[i];
+
+      const auto &plan = CQXmlPropertyPlan::get(preparedMeta_, nameValue.id);
+      if (! plan.valid) continue;
+
+      auto &preparedValue = preparedValues_[i];
+
+      if (plan.isEnum) {
+        auto p = plan.enumValues.find(nameValue.value);
+
+        if (p != plan.enumValues.end())
+          preparedValue.value = p.value();
+
+        preparedValue.prop = plan.prop;
+      }
+      else if (plan.type == QVariant::Icon || plan.type == QVariant::Pixmap) {
+        files.insert(nameValue.value);
+      }
+      else {
+        QVariant v(nameValue.value);
+
+        if (v.convert(plan.type))
+          preparedValue.value = v;
+
+        preparedValue.prop = plan.prop;
+      }
+    }
+  }
+
+  void applyLabels(QWidget *w) {
+    if      (qobject_cast<QTableWidget *>(w)) {
+      auto columnLabels = nameValue(CQXmlAttr::COLUMN_LABELS).split(' ');
+
+      if (columnLabels.length())
+        qobject_cast<QTableWidget *>(w)->setHorizontalHeaderLabels(columnLabels);
+
+      auto rowLabels = nameValue(CQXmlAttr::ROW_LABELS).split(' ');
+
+      if (rowLabels.length())
+        qobject_cast<QTableWidget *>(w)->setVerticalHeaderLabels(rowLabels);
+    }
+    else if (qobject_cast<QTreeWidget *>(w)) {
+      auto columnLabels = nameValue(CQXmlAttr::COLUMN_LABELS).split(' ');
+
+      if (columnLabels.length())
+        qobject_cast<QTreeWidget *>(w)->setHeaderLabels(columnLabels);
+    }
+  }
+
+  void applySizes(QWidget *w) {
+    QSize size;
+
+    if (sizeValue(CQXmlAttr::MINIMUM_SIZE, size))
+      w->setMinimumSize(size);
+    if (hasNameValue(CQXmlAttr::MINIMUM_WIDTH)) {
+      int w1 = intValue(CQXmlAttr::MINIMUM_WIDTH);
+
+      w->setMinimumWidth(w1);
+    }
+    if (hasNameValue(CQXmlAttr::MINIMUM_HEIGHT)) {
+      int h1 = intValue(CQXmlAttr::MINIMUM_HEIGHT);
+
+      w->setMinimumHeight(h1);
+    }
+    if (sizeValue(CQXmlAttr::MAXIMUM_SIZE, size))
+      w->setMaximumSize(size);
+    if (hasNameValue(CQXmlAttr::MAXIMUM_WIDTH)) {
+      int w1 = intValue(CQXmlAttr::MAXIMUM_WIDTH);
+
+      w->setMaximumWidth(w1);
+    }
+    if (hasNameValue(CQXmlAttr::MAXIMUM_HEIGHT)) {
+      int h1 = intValue(CQXmlAttr::MAXIMUM_HEIGHT);
+
+      w->setMaximumHeight(h1);
+    }
+    if (sizeValue(CQXmlAttr::FIXED_SIZE, size)) {
+      w->setMinimumWidth (size.width ()); w->setMaximumWidth (size.width ());
+      w->setMinimumHeight(size.height()); w->setMaximumHeight(size.height());
+    }
+    if (hasNameValue(CQXmlAttr::FIXED_WIDTH)) {
+      int w1 = intValue(CQXmlAttr::FIXED_WIDTH);
+
+      w->setMinimumWidth(w1); w->setMaximumWidth(w1);
+    }
+    if (hasNameValue(CQXmlAttr::FIXED_HEIGHT)) {
+      int h1 = intValue(CQXmlAttr::FIXED_HEIGHT);
+
+      w->setMinimumHeight(h1); w->setMaximumHeight(h1);
+    }
+  }
+
+ private:
+  QWidget *createWidgetI(const QString &text) {
+    using Phase = CQXmlStats::Phase;
+
+    auto *xml = getXml();
+
+    auto *factory = this->factory();
+    if (! factory) return nullptr;
+
+    CQXmlStatsTimer timer(xml->isStats() ? xml->stats() : nullptr, Phase::CONSTRUCT);
+
+    auto *w = factory->createWidget(options_);
+
+    object_ = w;
+
+    timer.setName(w->metaObject()->className());
+    timer.next(Phase::PROPERTIES);
+
+    if (hasNameValue(CQXmlAttr::NAME)) {
+      w->setObjectName(nameValue(CQXmlAttr::NAME));
+
+      getXml()->addWidget(nameValue(CQXmlAttr::NAME), w);
+    }
+
+    applyText(w, text);
+
+    // use values converted by prepare (if for same class)
+    bool prepared = (preparedMeta_ == w->metaObject() &&
+                     preparedValues_.size() == nameValues_.size());
+
+    for (size_t i = 0; i < nameValues_.size(); ++i) {
+      if (prepared && preparedValues_[i].prop.isValid()) {
+        const auto &preparedValue = preparedValues_[i];
+
+        if (preparedValue.value.isValid())
+          (void) preparedValue.prop.write(w, preparedValue.value);
+      }
+      else
+        (void) applyProperty(w, nameValues_[i]);
+    }
+
+    applyLabels(w);
+
+    timer.next(Phase::SIZES);
+
+    applySizes(w);
+
+    timer.stop();
+
+    if (hasNameValue(CQXmlAttr::MODEL) && qobject_cast<QAbstractItemView *>(w)) {
+      auto *view = qobject_cast<QAbstractItemView *>(w);
+
+      auto *model = xml->createModel(nameValue(CQXmlAttr::MODEL), view);
+
+      if (model)
+        view->setModel(model);
+    }
+    if (hasNameValue(CQXmlAttr::ON_CLICKED)) {
+      auto value = nameValue(CQXmlAttr::ON_CLICKED);
+      w->setProperty("onValue", value);
+      QObject::connect(w, SIGNAL(clicked()), xml, SLOT(onSlot()));
+    }
+
+    return w;
+  }
+
+ private:
+  // property value converted by prepare (invalid value if conversion failed)
+  struct PreparedValue {
+    QMetaProperty prop;
+    QVariant      value;
+  };
+
+  using PreparedValues = std::vector<PreparedValue>;
+
+  CQXmlWidgetFactory* factory_      { nullptr };
+  int                 generation_   { 0 };
+  QStringList         options_;
+  const QMetaObject*  preparedMeta_ { nullptr };
+  PreparedValues      preparedValues_;
+};
+
+class CQXmlLayoutTagFactory : public CQXmlTagFactory {
+ public:
+  CQXmlLayoutTagFactory(CQXmlUtil::LayoutType type) :
+   type_(type) {
+  }
+
+  CQXmlTag *createTag(const CXML *tag, CXMLTag *parent, const std::string &name,
+                      CXMLTag::OptionArray &options) override {
+    return new CQXmlLayoutTag(tag, parent, type_, name, options);
+  }
+
+ private:
+  CQXmlUtil::LayoutType type_;
+};
+
+class CQXmlStyleTagFactory : public CQXmlTagFactory {
+ public:
+  CQXmlStyleTagFactory(const std::string &style) :
+   style_(style) {
+  }
+
+  CQXmlTag *createTag(const CXML *tag, CXMLTag *parent, const std::string &name,
+                      CXMLTag::OptionArray &options) override {
+    return new CQXmlStyleTag(tag, parent, style_, name, options);
+  }
+
+ private:
+  std::string style_;
+};
+
+//------
+
+// builds widgets from start/end tag events without keeping a tag tree, only
+// the stack of open (in-progress) tags is kept
+class CQXmlStreamBuilder {
+ public:
+  CQXmlStreamBuilder(CQXml *xml, QWidget *parent);
+ ~CQXmlStreamBuilder();
+
+  bool read(QXmlStreamReader &reader);
+
+  CQXmlTag *startTag(const std::string &name);
+  CQXmlTag *startTag(const std::string &name, const CQXmlFactoryHandle &handle);
+
+  void addNameValue(const QString &name, const QString &value);
+  void addNameValue(int id, const QString &name, const QString &value, int numInts,
+                    const int ints[2]);
+
+  void addText(const QString &text);
+
+  void endTag();
+
+ private:
+  void buildEntry(size_t i);
+
+ private:
+  struct Entry {
+    CXMLTag*         tag      { nullptr };
+    CQXmlTag*        qtag     { nullptr };
+    bool             skip     { false };
+    bool             built    { false };
+    bool             lateText { false };
+    QWidget*         widget   { nullptr };
+    QLayout*         layout   { nullptr };
+    CQXmlItemStore*  items    { nullptr }; // item tags collected for item batch
+    QTreeWidgetItem* item     { nullptr }; // item of tree item tag
+  };
+
+  using Entries = std::vector<Entry>;
+
+  CQXml*   xml_    { nullptr };
+  QWidget* parent_ { nullptr };
+  Entries  entries_;
+};
+
+//------
+
+// compact binary form image: interned UTF-16 string table, tag name table with
+// resolved tag type and flat start tag/text/end tag records. Start tag records refer
+// to tag by name table index and attributes have ints of numeric values pre-parsed
+namespace CQXmlBinary {
+  const uint32_t magic   = 0x42585143; // "CQXB"
+  const uint32_t version = 2;
+
+  enum Op : uint32_t {
+    START_TAG = 1,
+    TEXT      = 2,
+    END_TAG   = 3
+  };
+
+  // followed by string index (offset, length), name table (string id, type),
+  // record words and string characters. Start tag record is name index, number of
+  // attributes and per attribute name string id, value string id, number of ints and
+  // ints
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numStrings;
+    uint32_t numNames;
+    uint32_t numWords;
+    uint32_t numChars;
+  };
+}
+
+class CQXmlBinaryWriter {
+ public:
+  CQXmlBinaryWriter(CQXml *xml) :
+   xml_(xml) {
+  }
+
+  bool read(QXmlStreamReader &reader);
+
+  bool write(const std::string &filename) const;
+
+ private:
+  uint32_t stringId(const QString &str);
+  uint32_t nameId  (const QString &name);
+
+ private:
+  using StringIds = QHash<QString, uint32_t>;
+  using Strings   = std::vector<QString>;
+  using Words     = std::vector<uint32_t>;
+
+  CQXml*    xml_ { nullptr };
+  StringIds stringIds_;
+  Strings   strings_;
+  StringIds nameIds_;
+  Words     names_;
+  Words     words_;
+};
+
+class CQXmlBinaryReader {
+ public:
+  CQXmlBinaryReader(CQXml *xml, QWidget *parent) :
+   xml_(xml), parent_(parent) {
+  }
+
+  bool read(const uchar *data, qint64 size);
+
+ private:
+  CQXml*   xml_    { nullptr };
+  QWidget* parent_ { nullptr };
+};
+
+//------
+
+// parsed tag tree kept for re-instantiation
+struct CQXmlTemplate {
+  CXML*         xml     { nullptr };
+  CQXmlFactory* factory { nullptr };
+  qint64        mtime   { 0 };
+  std::string   str; // source of string template (to check hash collisions)
+
+  QHash<QString, QImage> images; // icons decoded with tag tree (by worker thread)
+
+  CQXmlTemplate(CQXml *qxml) {
+    xml     = new CXML;
+    factory = new CQXmlFactory(qxml);
+
+    xml->setFactory(factory);
+  }
+
+ ~CQXmlTemplate() {
+    delete xml;
+  }
+};
+
+//------
+
+// widget subtree whose creation is postponed until it is needed. A placeholder
+// page takes the place of a page until the real page replaces it
+struct CQXmlDeferred {
+  using Type = CQXmlDeferredType;
+
+  Type                 type    { Type::PAGE };
+  CQXmlFactory*        factory { nullptr };
+  CQXmlTag*            ptag    { nullptr };
+  CQXmlTag*            tag     { nullptr };
+  QPointer<QWidget>    parent;  // page container (for page)
+  QPointer<QWidget>    widget;
+  CQXmlTreeWidgetItem* item    { nullptr }; // parent item (record removed with item)
+  QStringList          names; // names defined in subtree
+};
+
+CQXmlTreeWidgetItem::
+~CQXmlTreeWidgetItem()
+{
+  // children can no longer be created
+  if (deferred_)
+    deferred_->factory->getXml()->removeDeferred(deferred_);
+}
+
+//------
+
+CQXml::
+CQXml() :
+ parent_(nullptr)
+{
+  xml_ = new CXML;
+
+  iconCache_ = new CQXmlIconCache;
+
+  factory_ = new CQXmlFactory(this);
+
+  xml_->setFactory(factory_);
+
+  factoryHandles_["qxml"].type = CQXmlFactoryHandle::Type::ROOT;
+
+  addModelFactory("csv", new CQXmlCsvModelFactory(this));
+
+  CQXmlAddWidgetFactoryT(this, QCalendarWidget);
+  CQXmlAddWidgetFactoryT(this, QCheckBox);
+  CQXmlAddWidgetFactoryT(this, QColorDialog);
+  CQXmlAddWidgetFactoryT(this, QComboBox);
+  CQXmlAddWidgetFactoryT(this, QDial);
+  CQXmlAddWidgetFactoryT(this, QDialog);
+  CQXmlAddWidgetFactoryT(this, QDateEdit);
+  CQXmlAddWidgetFactoryT(this, QDateTimeEdit);
+  CQXmlAddWidgetFactoryT(this, QDockWidget);
+  CQXmlAddWidgetFactoryT(this, QDoubleSpinBox);
+  CQXmlAddWidgetFactoryT(this, QFileDialog);
+  CQXmlAddWidgetFactoryT(this, QFontComboBox);
+  CQXmlAddWidgetFactoryT(this, QFontDialog);
+  CQXmlAddWidgetFactoryT(this, QFrame);
+  CQXmlAddWidgetFactoryT(this, QGroupBox);
+  CQXmlAddWidgetFactoryT(this, QLabel);
+  CQXmlAddWidgetFactoryT(this, QLCDNumber);
+  CQXmlAddWidgetFactoryT(this, QLineEdit);
+  CQXmlAddWidgetFactoryT(this, QListView);
+  CQXmlAddWidgetFactoryT(this, QListWidget);
+  CQXmlAddWidgetFactoryT(this, QMainWindow);
+  CQXmlAddWidgetFactoryT(this, QMdiArea);
+  CQXmlAddWidgetFactoryT(this, QMdiSubWindow);
+  CQXmlAddWidgetFactoryT(this, QMenu);
+  CQXmlAddWidgetFactoryT(this, QMenuBar);
+  CQXmlAddWidgetFactoryT(this, QMessageBox);
+  CQXmlAddWidgetFactoryT(this, QPlainTextEdit);
+#ifdef PRINT_SUPPORT
+  CQXmlAddWidgetFactoryT(this, QPrintDialog);
+#endif
+  CQXmlAddWidgetFactoryT(this, QProgressBar);
+  CQXmlAddWidgetFactoryT(this, QProgressDialog);
+  CQXmlAddWidgetFactoryT(this, QPushButton);
+  CQXmlAddWidgetFactoryT(this, QRadioButton);
+  CQXmlAddWidgetFactoryT(this, QScrollArea);
+  CQXmlAddWidgetFactoryT(this, QScrollBar);
+  CQXmlAddWidgetFactoryT(this, QSlider);
+  CQXmlAddWidgetFactoryT(this, QSpinBox);
+  CQXmlAddWidgetFactoryT(this, QSplitter);
+  CQXmlAddWidgetFactoryT(this, QStackedWidget);
+  CQXmlAddWidgetFactoryT(this, QStatusBar);
+  CQXmlAddWidgetFactoryT(this, QTabBar);
+  CQXmlAddWidgetFactoryT(this, QTabWidget);
+  CQXmlAddWidgetFactoryT(this, QTableView);
+  CQXmlAddWidgetFactoryT(this, QTableWidget);
+  CQXmlAddWidgetFactoryT(this, QTextEdit);
+  CQXmlAddWidgetFactoryT(this, QToolBar);
+  CQXmlAddWidgetFactoryT(this, QToolBox);
+  CQXmlAddWidgetFactoryT(this, QToolButton);
+  CQXmlAddWidgetFactoryT(this, QTreeView);
+  CQXmlAddWidgetFactoryT(this, QTreeWidget);
+  CQXmlAddWidgetFactoryT(this, QUndoView);
+  CQXmlAddWidgetFactoryT(this, QWidget);
+#ifdef WEBVIEW_SUPPORT
+  CQXmlAddWidgetFactoryT(this, QWebView);
+#endif
+  CQXmlAddWidgetFactoryT(this, QWizard);
+  CQXmlAddWidgetFactoryT(this, QWizardPage);
+
+  CQXmlAddWidgetFactoryT(this, CQPropertyTree);
+  CQXmlAddTagFactoryT(this, "CQPropertyItem", CQXmlPropertyItemTag);
+
+  CQXmlAddTagFactoryT(this, "QLayoutItem", CQXmlLayoutItemTag);
+  CQXmlAddTagFactoryT(this, "QComboItem" , CQXmlComboItemTag );
+  CQXmlAddTagFactoryT(this, "QListItem"  , CQXmlListItemTag  );
+  CQXmlAddTagFactoryT(this, "QTableItem" , CQXmlTableItemTag );
+  CQXmlAddTagFactoryT(this, "QTreeItem"  , CQXmlTreeItemTag  );
+  CQXmlAddTagFactoryT(this, "QTabItem"   , CQXmlTabItemTag   );
+  CQXmlAddTagFactoryT(this, "QMenuTitle" , CQXmlMenuTitleTag );
+  CQXmlAddTagFactoryT(this, "QAction"    , CQXmlActionTag    );
+
+  CQXmlAddTagFactoryT(this, "connect", CQXmlConnectTag);
+
+  addTagFactory("QHBoxLayout", new CQXmlLayoutTagFactory(CQXmlUtil::HBoxLayout));
+  addTagFactory("QVBoxLayout", new CQXmlLayoutTagFactory(CQXmlUtil::VBoxLayout));
+  addTagFactory("QBoxLayout" , new CQXmlLayoutTagFactory(CQXmlUtil::BoxLayout ));
+  addTagFactory("QGridLayout", new CQXmlLayoutTagFactory(CQXmlUtil::GridLayout));
+  addTagFactory("QFormLayout", new CQXmlLayoutTagFactory(CQXmlUtil::FormLayout));
+
+  addTagFactory("h1", new CQXmlStyleTagFactory("h1"));
+  addTagFactory("h2", new CQXmlStyleTagFactory("h2"));
+  addTagFactory("h3", new CQXmlStyleTagFactory("h3"));
+  addTagFactory("h4", new CQXmlStyleTagFactory("h4"));
+  addTagFactory("p" , new CQXmlStyleTagFactory("p" ));
+}
+
+CQXml::
+~CQXml()
+{
+  // parse of watched file uses factories so must finish first
+  if (parseWatcher_) {
+    parseWatcher_->waitForFinished();
+
+    delete parseWatcher_->result();
+  }
+
+  for (auto &pa : asyncLoads_) {
+    pa.first->waitForFinished();
+
+    delete pa.first->result();
+  }
+
+  // remaining widgets of incremental build are not created
+  if (buildFactory_) {
+    buildFactory_->cancelBuild();
+
+    buildFactory_ = nullptr;
+  }
+
+  while (! deferred_.empty())
+    removeDeferred(*deferred_.begin());
+
+  clearTemplateCache();
+
+  delete xml_;
+
+  // icon cache waits for decodes which record into stats
+  delete iconCache_;
+
+  delete stats_;
+
+  delete trace_;
+}
+
+void
+CQXml::
+startTrace()
+{
+  delete trace_;
+
+  trace_ = new CQXmlTrace;
+}
+
+bool
+CQXml::
+stopTrace(const QString &filename)
+{
+  if (! trace_)
+    return false;
+
+  bool rc = trace_->write(filename);
+
+  delete trace_;
+
+  trace_ = nullptr;
+
+  return rc;
+}
+
+void
+CQXml::
+setStats(bool b)
+{
+  statsEnabled_ = b;
+
+  if (statsEnabled_ && ! stats_)
+    stats_ = new CQXmlStats;
+
+  iconCache_->setStats(statsEnabled_ ? stats_ : nullptr);
+}
+
+//-----
+
+bool
+CQXml::
+isWidgetFactory(const QString &name) const
+{
+  return (lookupFactory(name.toStdString()).widgetFactory != nullptr);
+}
+
+void
+CQXml::
+addWidgetFactory(const QString &name, CQXmlWidgetFactory *factory)
+{
+  QWriteLocker locker(&factoryLock_);
+
+  auto &handle = factoryHandles_[name.toStdString()];
+
+  // tags created with replaced factory must look it up again
+  if (handle.widgetFactory && handle.widgetFactory != factory)
+    factoryGeneration_.ref();
+
+  handle.widgetFactory = factory;
+
+  updateFactoryType(handle);
+}
+
+void
+CQXml::
+removeWidgetFactory(const QString &name)
+{
+  QWriteLocker locker(&factoryLock_);
+
+  auto p = factoryHandles_.find(name.toStdString());
+  assert(p != factoryHandles_.end() && (*p).second.widgetFactory);
+
+  // tags of kept tag trees and templates still reference factory
+  factoryGeneration_.ref();
+
+  (*p).second.widgetFactory = nullptr;
+
+  updateFactoryType((*p).second);
+}
+
+bool
+CQXml::
+isModelFactory(const QString &scheme) const
+{
+  return (modelFactories_.find(scheme) != modelFactories_.end());
+}
+
+void
+CQXml::
+addModelFactory(const QString &scheme, CQXmlModelFactory *factory)
+{
+  modelFactories_[scheme] = factory;
+}
+
+void
+CQXml::
+removeModelFactory(const QString &scheme)
+{
+  auto p = modelFactories_.find(scheme);
+  assert(p != modelFactories_.end());
+
+  modelFactories_.erase(p);
+}
+
+CQXmlModelFactory *
+CQXml::
+getModelFactory(const QString &scheme) const
+{
+  auto p = modelFactories_.find(scheme);
+
+  if (p == modelFactories_.end())
+    return nullptr;
+
+  return (*p).second;
+}
+
+QAbstractItemModel *
+CQXml::
+createModel(const QString &str, QObject *parent) const
+{
+  int pos = str.indexOf(':');
+
+  auto *factory = (pos > 0 ? getModelFactory(str.left(pos)) : nullptr);
+
+  if (! factory) {
+    std::cerr << "Invalid model '" << str.toStdString() << "'" << std::endl;
+    return nullptr;
+  }
+
+  return factory->createModel(str.mid(pos + 1), parent);
+}
+
+QString
+CQXml::
+filePath(const QString &path) const
+{
+  if (filename_.empty() || QFileInfo(path).isAbsolute())
+    return path;
+
+  return QFileInfo(filename_.c_str()).dir().filePath(path);
+}
+
+CQXmlWidgetFactory *
+CQXml::
+getWidgetFactory(const QString &name) const
+{
+  auto *factory = lookupFactory(name.toStdString()).widgetFactory;
+  assert(factory);
+
+  return factory;
+}
+
+//------
+
+bool
+CQXml::
+isTagFactory(const QString &name) const
+{
+  return (lookupFactory(name.toStdString()).tagFactory != nullptr);
+}
+
+void
+CQXml::
+addTagFactory(const QString &name, CQXmlTagFactory *factory)
+{
+  QWriteLocker locker(&factoryLock_);
+
+  auto &handle = factoryHandles_[name.toStdString()];
+
+  handle.tagFactory = factory;
+
+  updateFactoryType(handle);
+}
+
+void
+CQXml::
+removeTagFactory(const QString &name)
+{
+  QWriteLocker locker(&factoryLock_);
+
+  auto p = factoryHandles_.find(name.toStdString());
+  assert(p != factoryHandles_.end() && (*p).second.tagFactory);
+
+  (*p).second.tagFactory = nullptr;
+
+  updateFactoryType((*p).second);
+}
+
+CQXmlTagFactory *
+CQXml::
+getTagFactory(const QString &name) const
+{
+  auto *factory = lookupFactory(name.toStdString()).tagFactory;
+  assert(factory);
+
+  return factory;
+}
+
+//------
+
+CQXmlFactoryHandle
+CQXml::
+lookupFactory(const std::string &name) const
+{
+  // tags are also created by parses on worker threads
+  QReadLocker locker(&factoryLock_);
+
+  auto p = factoryHandles_.find(name);
+
+  CQXmlFactoryHandle handle;
+
+  if (p != factoryHandles_.end())
+    handle = (*p).second;
+
+  handle.generation = factoryGeneration_.loadAcquire();
+
+  return handle;
+}
+
+void
+CQXml::
+updateFactoryType(CQXmlFactoryHandle &handle)
+{
+  using Type = CQXmlFactoryHandle::Type;
+
+  // root tag name takes precedence, then tag factory, then widget factory
+  if      (handle.type == Type::ROOT)
+    return;
+  else if (handle.tagFactory)
+    handle.type = Type::TAG;
+  else if (handle.widgetFactory)
+    handle.type = Type::WIDGET;
+  else
+    handle.type = Type::NONE;
+}
+
+//------
+
+bool
+CQXml::
+createWidgetsFromString(QWidget *parent, const std::string &str)
+{
+  parent_ = parent;
+
+  template_ = nullptr;
+
+  filename_.clear();
+  fileTree_ = false;
+
+  if (watchFile_)
+    updateWatch();
+
+  if (isStreaming()) {
+    QXmlStreamReader reader(QByteArray(str.c_str(), int(str.size())));
+
+    return streamWidgets(reader);
+  }
+
+  if ((isArenaBuild() || isDiscardParseTree()) && ! isCacheTemplates())
+    return transientWidgets(parent, str, /*isFile*/false);
+
+  if (isCacheTemplates()) {
+    auto key = QString("#%1").arg(qHash(QByteArray::fromRawData(str.c_str(), int(str.size()))));
+
+    auto p = templates_.find(key);
+
+    if (p != templates_.end() && (*p).second->str == str) {
+      ++templateCacheHits_;
+
+      template_ = (*p).second;
+    }
+    else {
+      ++templateCacheMisses_;
+
+      auto *tmpl = new CQXmlTemplate(this);
+
+      CXMLTag *tag;
+
+      if (! parse(tmpl->xml, str, /*isFile*/false, &tag) || ! tmpl->factory->root()) {
+        delete tmpl;
+        return false;
+      }
+
+      tmpl->str = str;
+
+      addTemplate(key, tmpl);
+    }
+
+    return instantiate(parent);
+  }
+
+  resetTree();
+
+  CXMLTag *tag;
+
+  if (! parse(xml_, str, /*isFile*/false, &tag))
+    return false;
+
+  return instantiate(parent);
+}
+
+bool
+CQXml::
+createWidgetsFromFile(QWidget *parent, const std::string &filename)
+{
+  parent_ = parent;
+
+  template_ = nullptr;
+
+  filename_ = filename;
+  fileTree_ = false;
+
+  if (watchFile_)
+    updateWatch();
+
+  if (isStreaming()) {
+    QFile file(filename.c_str());
+
+    if (! file.open(QIODevice::ReadOnly))
+      return false;
+
+    QXmlStreamReader reader(&file);
+
+    return streamWidgets(reader);
+  }
+
+  if ((isArenaBuild() || isDiscardParseTree()) && ! isCacheTemplates())
+    return transientWidgets(parent, filename, /*isFile*/true);
+
+  if (isCacheTemplates()) {
+    QFileInfo fi(filename.c_str());
+
+    if (! fi.exists())
+      return false;
+
+    auto key   = fi.absoluteFilePath();
+    auto mtime = fi.lastModified().toMSecsSinceEpoch();
+
+    auto p = templates_.find(key);
+
+    if (p != templates_.end() && (*p).second->mtime == mtime) {
+      ++templateCacheHits_;
+
+      template_ = (*p).second;
+    }
+    else {
+      ++templateCacheMisses_;
+
+      auto *tmpl = new CQXmlTemplate(this);
+
+      CXMLTag *tag;
+
+      if (! parse(tmpl->xml, filename, /*isFile*/true, &tag) || ! tmpl->factory->root()) {
+        delete tmpl;
+        return false;
+      }
+
+      tmpl->mtime = mtime;
+
+      addTemplate(key, tmpl);
+    }
+
+    return instantiate(parent);
+  }
+
+  resetTree();
+
+  CXMLTag *tag;
+
+  if (! parse(xml_, filename, /*isFile*/true, &tag))
+    return false;
+
+  fileTree_ = true;
+
+  return instantiate(parent);
+}
+
+bool
+CQXml::
+parse(CXML *xml, const std::string &str, bool isFile, CXMLTag **tag)
+{
+  CQXmlStatsTimer timer(isStats() ? stats_ : nullptr, CQXmlStats::Phase::PARSE,
+                        isFile ? str.c_str() : "<string>");
+
+  CQXmlTraceScope trace(trace_, "parse", trace_ && isFile ? QString(str.c_str()) : QString());
+
+  return (isFile ? xml->read(str, tag) : xml->readString(str, tag));
+}
+
+// parse into temporary tag tree which is freed when widgets are built
+bool
+CQXml::
+transientWidgets(QWidget *parent, const std::string &str, bool isFile)
+{
+  // destruction order: tag tree, arena scope, then arena (single release)
+  CQXmlArena      arena;
+  CQXmlArenaScope scope(isArenaBuild() ? &arena : nullptr);
+  CQXmlTemplate   tmpl(this);
+
+  tmpl.factory->setDeferAllowed(false);
+
+  CXMLTag *tag;
+
+  if (! parse(tmpl.xml, str, isFile, &tag) || ! tmpl.factory->root())
+    return false;
+
+  parent_ = parent;
+
+  tmpl.factory->createWidgets(parent);
+
+  parseMemory_.releasedBytes += tmpl.factory->root()->memoryBytes();
+
+  return true;
+}
+
+void
+CQXml::
+releaseParseTree()
+{
+  fileTree_ = false;
+
+  auto *root = factory_->root();
+
+  if (root)
+    parseMemory_.releasedBytes += root->memoryBytes();
+
+  resetTree();
+}
+
+// replace kept tag tree by empty one
+void
+CQXml::
+resetTree()
+{
+  retireTree(xml_, factory_);
+
+  xml_ = new CXML;
+
+  factory_ = new CQXmlFactory(this);
+
+  xml_->setFactory(factory_);
+}
+
+// delete replaced tag tree (and its factory) or keep it until its deferred records
+// are built or removed
+void
+CQXml::
+retireTree(CXML *xml, CQXmlFactory *factory)
+{
+  // incremental build needs tag tree
+  if (buildFactory_ == factory)
+    finishBuild();
+
+  if (treeRefs_.find(factory) != treeRefs_.end())
+    retiredTrees_[factory] = xml;
+  else
+    delete xml; // factory is owned by (and deleted with) its CXML
+}
+
+void
+CQXml::
+releaseTree(CQXmlFactory *factory)
+{
+  auto p = treeRefs_.find(factory);
+  if (p == treeRefs_.end()) return;
+
+  if (--(*p).second > 0)
+    return;
+
+  treeRefs_.erase(p);
+
+  auto pr = retiredTrees_.find(factory);
+
+  if (pr != retiredTrees_.end()) {
+    delete (*pr).second;
+
+    retiredTrees_.erase(pr);
+  }
+}
+
+CQXml::ParseMemory
+CQXml::
+parseMemory() const
+{
+  auto memory = parseMemory_;
+
+  memory.retainedBytes = 0;
+
+  auto *root = factory_->root();
+
+  if (root)
+    memory.retainedBytes += root->memoryBytes();
+
+  for (const auto &pt : templates_)
+    memory.retainedBytes += pt.second->factory->root()->memoryBytes();
+
+  return memory;
+}
+
+bool
+CQXml::
+instantiate(QWidget *parent)
+{
+  auto *factory = (template_ ? template_->factory : factory_);
+
+  if (! factory->root())
+    return false;
+
+  parent_ = parent;
+
+  factory->createWidgets(parent);
+
+  return true;
+}
+
+//------
+
+// objects of matched tags are moved from old to new tag tree during reload
+struct CQXmlReloadState {
+  using DeferredMap = std::map<CQXmlTag *, CQXmlDeferred *>;
+
+  CQXmlFactory*        factory { nullptr }; // factory of new tag tree
+  QSet<QString>        names;               // names of created objects
+  std::set<CQXmlTag *> built;               // new tags whose subtree was created
+  DeferredMap          deferred;            // deferred records of old tags
+};
+
+// helpers to match old and new tag trees on reload
+namespace CQXmlReloadUtil {
+
+  // tags which own the object they create (widget or layout)
+  bool isObjectTag(CQXmlTag *tag) {
+    return (dynamic_cast<CQXmlQtWidgetTag *>(tag) ||
+            dynamic_cast<CQXmlLayoutTag   *>(tag) ||
+            dynamic_cast<CQXmlStyleTag    *>(tag));
+  }
+
+  bool isSameValues(CQXmlTag *tag1, CQXmlTag *tag2) {
+    if (tag1->nameValues().size() != tag2->nameValues().size())
+      return false;
+
+    for (const auto &nameValue : tag1->nameValues()) {
+      if (! tag2->hasNameValue(nameValue.id) || tag2->nameValue(nameValue.id) != nameValue.value)
+        return false;
+    }
+
+    return true;
+  }
+
+  std::vector<CQXmlTag *> childTags(CQXmlTag *tag) {
+    std::vector<CQXmlTag *> tags;
+
+    for (size_t i = 0; i < tag->getNumChildren(); ++i) {
+      const auto *token = tag->getChild(int(i));
+
+      auto *tag1 = (token->isTag() ? dynamic_cast<CQXmlTag *>(token->getTag()) : nullptr);
+
+      if (tag1)
+        tags.push_back(tag1);
+    }
+
+    return tags;
+  }
+
+  // compare tag and its children
+  bool isSameTag(CQXmlTag *tag1, CQXmlTag *tag2) {
+    if (tag1->getName() != tag2->getName() || tag1->getText() != tag2->getText() ||
+        ! isSameValues(tag1, tag2))
+      return false;
+
+    auto tags1 = childTags(tag1);
+    auto tags2 = childTags(tag2);
+
+    if (tags1.size() != tags2.size())
+      return false;
+
+    for (size_t i = 0; i < tags1.size(); ++i)
+      if (! isSameTag(tags1[i], tags2[i]))
+        return false;
+
+    return true;
+  }
+
+  // row of object (widget or layout) in form layout (-1 if not found)
+  int formRow(QFormLayout *form, QObject *obj) {
+    int row = -1;
+
+    QFormLayout::ItemRole role;
+
+    if      (qobject_cast<QWidget *>(obj))
+      form->getWidgetPosition(qobject_cast<QWidget *>(obj), &row, &role);
+    else if (qobject_cast<QLayout *>(obj))
+      form->getLayoutPosition(qobject_cast<QLayout *>(obj), &row, &role);
+
+    return row;
+  }
+
+  // remove row of object from form layout and delete its label (object is deleted
+  // by caller)
+  void removeFormRow(QLayout *layout, QObject *obj) {
+    auto *form = qobject_cast<QFormLayout *>(layout);
+    if (! form || ! obj) return;
+
+    int row = formRow(form, obj);
+    if (row < 0) return;
+
+    auto items = form->takeRow(row);
+
+    if (items.labelItem) {
+      auto *label = items.labelItem->widget();
+
+      delete items.labelItem;
+      delete label;
+    }
+
+    // layout is its own item
+    if (items.fieldItem && items.fieldItem->widget())
+      delete items.fieldItem;
+  }
+
+  // move object (last child) before other child of layout or page container
+  void reloadMove(QWidget *widget, QLayout *layout, QObject *obj, QObject *before) {
+    if      (qobject_cast<QBoxLayout *>(layout)) {
+      auto *box = qobject_cast<QBoxLayout *>(layout);
+
+      for (int i = 0; i < box->count(); ++i) {
+        auto *item = box->itemAt(i);
+
+        if (item->widget() != before && item->layout() != before)
+          continue;
+
+        if      (qobject_cast<QWidget *>(obj)) {
+          box->removeWidget(qobject_cast<QWidget *>(obj));
+          box->insertWidget(i, qobject_cast<QWidget *>(obj));
+        }
+        else if (qobject_cast<QLayout *>(obj)) {
+          box->removeItem(qobject_cast<QLayout *>(obj));
+          box->insertLayout(i, qobject_cast<QLayout *>(obj));
+        }
+
+        break;
+      }
+    }
+    else if (qobject_cast<QFormLayout *>(layout)) {
+      auto *form = qobject_cast<QFormLayout *>(layout);
+
+      int row  = formRow(form, before);
+      int orow = formRow(form, obj);
+
+      if (row < 0 || orow < 0)
+        return;
+
+      // row moves with its label
+      auto items = form->takeRow(orow);
+
+      auto *label = (items.labelItem ? items.labelItem->widget() : nullptr);
+
+      delete items.labelItem;
+
+      if (qobject_cast<QWidget *>(obj)) {
+        delete items.fieldItem;
+
+        form->insertRow(row, label, qobject_cast<QWidget *>(obj));
+      }
+      else
+        form->insertRow(row, label, qobject_cast<QLayout *>(obj));
+    }
+    else if (widget && qobject_cast<QWidget *>(obj) && qobject_cast<QWidget *>(before)) {
+      int ind = CQXmlUtil::pageIndex(widget, qobject_cast<QWidget *>(before));
+
+      if (ind >= 0)
+        CQXmlUtil::movePage(widget, qobject_cast<QWidget *>(obj), ind);
+    }
+  }
+
+  bool isSizeAttr(int id) {
+    using namespace CQXmlAttr;
+
+    return (id == MINIMUM_SIZE || id == MINIMUM_WIDTH || id == MINIMUM_HEIGHT ||
+            id == MAXIMUM_SIZE || id == MAXIMUM_WIDTH || id == MAXIMUM_HEIGHT ||
+            id == FIXED_SIZE || id == FIXED_WIDTH || id == FIXED_HEIGHT);
+  }
+
+}
+
+using namespace CQXmlReloadUtil;
+
+bool
+CQXml::
+reload()
+{
+  if (filename_.empty() || ! parent_)
+    return false;
+
+  // minimal update needs tag tree (and its objects) from last load
+  if (! fileTree_ || ! factory_->root()) {
+    auto filename = filename_;
+
+    clearWidgets();
+
+    return createWidgetsFromFile(parent_, filename);
+  }
+
+  auto *tmpl = parseTemplate(filename_);
+
+  if (! tmpl)
+    return false;
+
+  return reloadTemplate(tmpl);
+}
+
+// parse file into new tag tree (can be called from worker thread)
+CQXmlTemplate *
+CQXml::
+parseTemplate(const std::string &filename)
+{
+  auto *tmpl = new CQXmlTemplate(this);
+
+  CXMLTag *tag;
+
+  if (! parse(tmpl->xml, filename, /*isFile*/true, &tag) || ! tmpl->factory->root()) {
+    delete tmpl;
+    return nullptr;
+  }
+
+  return tmpl;
+}
+
+// update widgets of last load from new tag tree (which replaces kept tree)
+bool
+CQXml::
+reloadTemplate(CQXmlTemplate *tmpl)
+{
+  CQXmlTraceScope trace(trace_, "reload", trace_ ? QString(filename_.c_str()) : QString());
+
+  CQXmlReloadState state;
+
+  state.factory = tmpl->factory;
+
+  for (auto *deferred : deferred_)
+    if (deferred->factory == factory_)
+      state.deferred[deferred->tag] = deferred;
+
+  bool rc = reloadRoot(state, factory_->root(), tmpl->factory->root());
+
+  // new tag tree replaces old
+  retireTree(xml_, factory_);
+
+  xml_     = tmpl->xml;
+  factory_ = tmpl->factory;
+
+  tmpl->xml = nullptr;
+
+  delete tmpl;
+
+  if (! rc) {
+    clearWidgets();
+
+    return instantiate(parent_);
+  }
+
+  // connections (and property items) to recreated objects
+  if (! state.names.isEmpty())
+    reloadExec(state, nullptr, factory_->root());
+
+  return true;
+}
+
+void
+CQXml::
+setWatchFile(bool b)
+{
+  watchFile_ = b;
+
+  updateWatch();
+}
+
+// watch file of last load (if enabled)
+void
+CQXml::
+updateWatch()
+{
+  if (! watchFile_) {
+    delete fileWatcher_;
+
+    fileWatcher_ = nullptr;
+
+    return;
+  }
+
+  if (! fileWatcher_) {
+    fileWatcher_ = new QFileSystemWatcher(this);
+
+    connect(fileWatcher_, SIGNAL(fileChanged(const QString &)),
+            this, SLOT(watchFileSlot(const QString &)));
+  }
+
+  if (! watchTimer_) {
+    watchTimer_ = new QTimer(this);
+
+    watchTimer_->setSingleShot(true);
+
+    connect(watchTimer_, SIGNAL(timeout()), this, SLOT(watchTimerSlot()));
+  }
+
+  auto files = fileWatcher_->files();
+
+  if (! files.isEmpty())
+    fileWatcher_->removePaths(files);
+
+  if (! filename_.empty())
+    fileWatcher_->addPath(filename_.c_str());
+}
+
+void
+CQXml::
+watchFileSlot(const QString &filename)
+{
+  // editors which save by replacing file remove it from the watcher
+  if (! fileWatcher_->files().contains(filename) && QFileInfo(filename).exists())
+    fileWatcher_->addPath(filename);
+
+  // restart delay so burst of writes gives single reload
+  watchTimer_->start(watchDelay_);
+}
+
+void
+CQXml::
+watchTimerSlot()
+{
+  if (! watchFile_ || filename_.empty())
+    return;
+
+  // file may have been replaced after last change
+  if (fileWatcher_ && ! fileWatcher_->files().contains(filename_.c_str()))
+    fileWatcher_->addPath(filename_.c_str());
+
+  // without kept tag tree (or parent) reload rebuilds synchronously
+  if (! fileTree_ || ! factory_->root() || ! parent_) {
+    Q_EMIT fileReloaded(reload());
+    return;
+  }
+
+  // parse again when current parse finishes
+  if (parseWatcher_) {
+    watchPending_ = true;
+    return;
+  }
+
+  parseWatcher_ = new ParseWatcher(this);
+
+  parseWatcher_->setProperty("filename", QString(filename_.c_str()));
+
+  connect(parseWatcher_, SIGNAL(finished()), this, SLOT(watchParsedSlot()));
+
+  auto filename = filename_;
+
+  parseWatcher_->setFuture(QtConcurrent::run([this, filename]() {
+    return parseTemplate(filename);
+  }));
+}
+
+void
+CQXml::
+watchParsedSlot()
+{
+  auto filename = parseWatcher_->property("filename").toString();
+
+  auto *tmpl = parseWatcher_->result();
+
+  parseWatcher_->deleteLater();
+
+  parseWatcher_ = nullptr;
+
+  // apply only if same file is still loaded with its tag tree
+  if (tmpl) {
+    if (filename == filename_.c_str() && fileTree_ && factory_->root() && parent_)
+      Q_EMIT fileReloaded(reloadTemplate(tmpl));
+    else
+      delete tmpl;
+  }
+  else
+    Q_EMIT fileReloaded(false);
+
+  if (watchPending_) {
+    watchPending_ = false;
+
+    watchTimerSlot();
+  }
+}
+
+namespace CQXmlAsyncUtil {
+  // prepare widget tags and collect icon files of tag and its children
+  void prepareTag(CQXmlTag *tag, QSet<QString> &files) {
+    for (const auto &nameValue : tag->nameValues()) {
+      if (CQXmlAttr::isIcon(nameValue.id))
+        files.insert(nameValue.value);
+    }
+
+    auto *wtag = dynamic_cast<CQXmlQtWidgetTag *>(tag);
+
+    if (wtag)
+      wtag->prepare(files);
+
+    for (auto *tag1 : childTags(tag))
+      prepareTag(tag1, files);
+  }
+}
+
+bool
+CQXml::
+createWidgetsAsync(QWidget *parent, const std::string &filename)
+{
+  if (! parent || ! QFileInfo(filename.c_str()).exists())
+    return false;
+
+  auto *watcher = new ParseWatcher(this);
+
+  watcher->setProperty("filename", QString(filename.c_str()));
+
+  asyncLoads_[watcher] = parent;
+
+  connect(watcher, SIGNAL(finished()), this, SLOT(asyncParsedSlot()));
+
+  // icon cache already decodes on thread pool when prefetching
+  bool decodeIcons = ! iconCache_->isAsyncDecode();
+
+  watcher->setFuture(QtConcurrent::run([this, filename, decodeIcons]() {
+    auto *tmpl = parseTemplate(filename);
+
+    if (tmpl)
+      prepareTemplate(tmpl, decodeIcons);
+
+    return tmpl;
+  }));
+
+  return true;
+}
+
+// convert property values and decode icons of parsed tag tree (called from worker thread)
+void
+CQXml::
+prepareTemplate(CQXmlTemplate *tmpl, bool decodeIcons)
+{
+  CQXmlTraceScope trace(trace_, "prepare");
+
+  QSet<QString> files;
+
+  CQXmlAsyncUtil::prepareTag(tmpl->factory->root(), files);
+
+  if (! decodeIcons)
+    return;
+
+  auto *stats = (isStats() ? stats_ : nullptr);
+
+  for (const auto &file : files) {
+    QElapsedTimer timer;
+
+    if (stats)
+      timer.start();
+
+    tmpl->images[file] = QImage(file);
+
+    if (stats)
+      stats->add(CQXmlStats::Phase::ICON_DECODE, file, timer.nsecsElapsed());
+  }
+}
+
+void
+CQXml::
+asyncParsedSlot()
+{
+  auto *watcher = static_cast<ParseWatcher *>(sender());
+
+  auto p = asyncLoads_.find(watcher);
+  if (p == asyncLoads_.end()) return;
+
+  QPointer<QWidget> parent = (*p).second;
+
+  asyncLoads_.erase(p);
+
+  auto filename = watcher->property("filename").toString().toStdString();
+
+  auto *tmpl = watcher->result();
+
+  watcher->deleteLater();
+
+  // parent may have been deleted during parse
+  if (! tmpl || ! parent) {
+    delete tmpl;
+
+    Q_EMIT widgetsCreated(parent, false);
+
+    return;
+  }
+
+  Q_EMIT widgetsCreated(parent, applyTemplate(parent, filename, tmpl));
+}
+
+// create widgets from tag tree parsed by worker thread (which replaces kept tree)
+bool
+CQXml::
+applyTemplate(QWidget *parent, const std::string &filename, CQXmlTemplate *tmpl)
+{
+  // pixmaps can only be created in gui thread
+  for (auto p = tmpl->images.begin(); p != tmpl->images.end(); ++p)
+    iconCache_->addImage(p.key(), p.value());
+
+  retireTree(xml_, factory_);
+
+  xml_     = tmpl->xml;
+  factory_ = tmpl->factory;
+
+  tmpl->xml = nullptr;
+
+  delete tmpl;
+
+  template_ = nullptr;
+
+  filename_ = filename;
+  fileTree_ = true;
+
+  if (watchFile_)
+    updateWatch();
+
+  bool rc = instantiate(parent);
+
+  if (isDiscardParseTree() && ! isCacheTemplates())
+    releaseParseTree();
+
+  return rc;
+}
+
+bool
+CQXml::
+createWidgetsFromFiles(FileLoads &loads)
+{
+  CQXmlTraceScope trace(trace_, "loadFiles");
+
+  // start all parses (pool runs as many as there are cores)
+  std::vector<QFuture<CQXmlTemplate *>> futures;
+
+  futures.reserve(loads.size());
+
+  for (const auto &load : loads) {
+    auto filename = load.filename;
+
+    futures.push_back(QtConcurrent::run([this, filename]() {
+      auto *tmpl = parseTemplate(filename);
+
+      if (tmpl)
+        prepareTemplate(tmpl, /*decodeIcons*/true);
+
+      return tmpl;
+    }));
+  }
+
+  // create widgets in list order as each parse finishes
+  bool rc = true;
+
+  for (size_t i = 0; i < loads.size(); ++i) {
+    auto &load = loads[i];
+
+    auto *tmpl = futures[i].result();
+
+    if (tmpl && load.parent)
+      load.rc = applyTemplate(load.parent, load.filename, tmpl);
+    else {
+      delete tmpl;
+
+      load.rc = false;
+    }
+
+    if (! load.rc)
+      rc = false;
+  }
+
+  return rc;
+}
+
+// delete widgets and layout created in parent by last load
+void
+CQXml::
+clearWidgets()
+{
+  // remaining widgets of incremental build are not created
+  if (buildFactory_) {
+    buildTimer_->stop();
+
+    buildFactory_->cancelBuild();
+
+    endBuild();
+  }
+
+  while (! deferred_.empty())
+    removeDeferred(*deferred_.begin());
+
+  if (CQXmlUtil::allowLayout(parent_))
+    delete parent_->layout();
+
+  for (auto *w : parent_->findChildren<QWidget *>(QString(), Qt::FindDirectChildrenOnly))
+    delete w;
+
+  layouts_.clear();
+  widgets_.clear();
+  actions_.clear();
+}
+
+bool
+CQXml::
+reloadRoot(CQXmlReloadState &state, CQXmlTag *otag, CQXmlTag *ntag)
+{
+  auto *oroot = dynamic_cast<CQXmlRootTag *>(otag);
+  auto *nroot = dynamic_cast<CQXmlRootTag *>(ntag);
+
+  if (oroot->type() != nroot->type() ||
+      oroot->nameValue(CQXmlAttr::DIRECTION) != nroot->nameValue(CQXmlAttr::DIRECTION))
+    return false;
+
+  if (nroot->windowTitle() != oroot->windowTitle())
+    parent_->setWindowTitle(nroot->windowTitle());
+
+  // same parent as CQXmlFactory::createWidgets(QWidget *)
+  QLayout *layout = nullptr;
+
+  if (CQXmlUtil::allowLayout(parent_) && nroot->type() != CQXmlUtil::NoLayout)
+    layout = parent_->layout();
+
+  if (layout)
+    return reloadChildren(state, otag, ntag, nullptr, layout);
+  else
+    return reloadChildren(state, otag, ntag, parent_, nullptr);
+}
+
+// match child tags of old and new tag and update, add or remove objects in parent
+// widget or layout (false if parent must be rebuilt)
+bool
+CQXml::
+reloadChildren(CQXmlReloadState &state, CQXmlTag *otag, CQXmlTag *ntag,
+               QWidget *widget, QLayout *layout)
+{
+  using Tags = std::vector<CQXmlTag *>;
+  using Keys = std::vector<QString>;
+
+  // split children into tags with objects (keyed by name or position among unnamed
+  // tags of same type) and other tags (items, actions, spacers, connections) which
+  // are keyed by the preceding object tag
+  auto splitTags = [](CQXmlTag *tag, Tags &tags, Keys &keys, Tags &others, Keys &anchors) {
+    std::map<std::string, int> counts;
+
+    QString key;
+
+    for (auto *tag1 : childTags(tag)) {
+      if (! isObjectTag(tag1)) {
+        others .push_back(tag1);
+        anchors.push_back(key);
+        continue;
+      }
+
+      if (tag1->hasNameValue(CQXmlAttr::NAME))
+        key = QString("%1:%2").arg(tag1->getName().c_str()).
+                arg(tag1->nameValue(CQXmlAttr::NAME));
+      else
+        key = QString("%1#%2").arg(tag1->getName().c_str()).arg(counts[tag1->getName()]++);
+
+      tags.push_back(tag1);
+      keys.push_back(key);
+    }
+  };
+
+  Tags otags, ntags, oothers, nothers;
+  Keys okeys, nkeys, oanchors, nanchors;
+
+  splitTags(otag, otags, okeys, oothers, oanchors);
+  splitTags(ntag, ntags, nkeys, nothers, nanchors);
+
+  // other tags are not updated so any change rebuilds parent
+  if (oothers.size() != nothers.size() || oanchors != nanchors)
+    return false;
+
+  for (size_t i = 0; i < oothers.size(); ++i)
+    if (! isSameTag(oothers[i], nothers[i]))
+      return false;
+
+  // matched tags must be in same order
+  std::map<QString, int> okeyInd;
+
+  for (size_t i = 0; i < okeys.size(); ++i)
+    okeyInd[okeys[i]] = int(i);
+
+  std::vector<int>  matches(ntags.size(), -1);
+  std::vector<bool> used   (otags.size(), false);
+
+  int lastInd = -1;
+
+  for (size_t i = 0; i < ntags.size(); ++i) {
+    auto p = okeyInd.find(nkeys[i]);
+    if (p == okeyInd.end()) continue;
+
+    if ((*p).second <= lastInd)
+      return false;
+
+    lastInd = (*p).second;
+
+    matches[i] = lastInd;
+
+    used[size_t(lastInd)] = true;
+  }
+
+  for (size_t i = 0; i < otags.size(); ++i) {
+    if (! used[i]) {
+      removeFormRow(layout, otags[i]->object());
+
+      destroyTag(state, otags[i]);
+    }
+  }
+
+  // update or create from last so object to insert before is known
+  QObject *before = nullptr;
+
+  for (int i = int(ntags.size()) - 1; i >= 0; --i) {
+    auto *ntag1 = ntags[size_t(i)];
+
+    if (matches[size_t(i)] >= 0) {
+      auto *otag1 = otags[size_t(matches[size_t(i)])];
+
+      if (! reloadTag(state, ntag, otag1, ntag1)) {
+        removeFormRow(layout, otag1->object());
+
+        destroyTag(state, otag1);
+
+        reloadBuild(state, ntag, ntag1, widget, layout, before);
+      }
+    }
+    else
+      reloadBuild(state, ntag, ntag1, widget, layout, before);
+
+    if (ntag1->object())
+      before = ntag1->object();
+  }
+
+  return true;
+}
+
+// update object of old tag in place for new tag (false if it must be recreated)
+bool
+CQXml::
+reloadTag(CQXmlReloadState &state, CQXmlTag *ptag, CQXmlTag *otag, CQXmlTag *ntag)
+{
+  if (otag->getName() != ntag->getName())
+    return false;
+
+  // deferred subtree is not created so its record can use the new tag as is
+  auto pd = state.deferred.find(otag);
+
+  if (pd != state.deferred.end()) {
+    auto *deferred = (*pd).second;
+
+    if (otag->getText() != ntag->getText() || ! isSameValues(otag, ntag))
+      return false;
+
+    state.deferred.erase(pd);
+
+    ++treeRefs_[state.factory];
+
+    releaseTree(deferred->factory);
+
+    deferred->factory = state.factory;
+    deferred->ptag    = ptag;
+    deferred->tag     = ntag;
+
+    if (deferred->type != CQXmlDeferred::Type::ITEM) {
+      deferred->names.clear();
+
+      ntag->addNames(deferred->names);
+    }
+
+    ntag->setObject(otag->object());
+
+    return true;
+  }
+
+  auto *obj = otag->object();
+  if (! obj) return false;
+
+  if      (dynamic_cast<CQXmlQtWidgetTag *>(ntag)) {
+    auto *wtag = dynamic_cast<CQXmlQtWidgetTag *>(ntag);
+
+    auto *w = qobject_cast<QWidget *>(obj);
+
+    // attribute value can't be reset so removed attributes recreate widget
+    for (const auto &nameValue : otag->nameValues())
+      if (! ntag->hasNameValue(nameValue.id))
+        return false;
+
+    bool sizes = false, labels = false;
+
+    for (const auto &nameValue : ntag->nameValues()) {
+      if (otag->nameValue(nameValue.id) == nameValue.value)
+        continue;
+
+      if      (nameValue.id == CQXmlAttr::TEXT)
+        continue;
+      else if (isSizeAttr(nameValue.id))
+        sizes = true;
+      else if (nameValue.id == CQXmlAttr::COLUMN_LABELS || nameValue.id == CQXmlAttr::ROW_LABELS)
+        labels = true;
+      else if (! wtag->applyProperty(w, nameValue))
+        return false;
+    }
+
+    if (otag->getText() != ntag->getText())
+      wtag->applyText(w, ntag->getText());
+
+    if (labels) wtag->applyLabels(w);
+    if (sizes ) wtag->applySizes (w);
+
+    ntag->setObject(w);
+
+    return reloadChildren(state, otag, ntag, w, nullptr);
+  }
+  else if (dynamic_cast<CQXmlLayoutTag *>(ntag)) {
+    auto *olayoutTag = dynamic_cast<CQXmlLayoutTag *>(otag);
+    auto *nlayoutTag = dynamic_cast<CQXmlLayoutTag *>(ntag);
+
+    auto *l = qobject_cast<QLayout *>(obj);
+
+    if (olayoutTag->type() != nlayoutTag->type())
+      return false;
+
+    // only margin and spacing can be updated
+    for (const auto &nameValue : otag->nameValues()) {
+      if (nameValue.id == CQXmlAttr::MARGIN || nameValue.id == CQXmlAttr::SPACING)
+        continue;
+
+      if (! ntag->hasNameValue(nameValue.id) || ntag->nameValue(nameValue.id) != nameValue.value)
+        return false;
+    }
+
+    for (const auto &nameValue : ntag->nameValues()) {
+      if (nameValue.id != CQXmlAttr::MARGIN && nameValue.id != CQXmlAttr::SPACING &&
+          ! otag->hasNameValue(nameValue.id))
+        return false;
+    }
+
+    int margin = 2, spacing = 2;
+
+    if (ntag->hasNameValue(CQXmlAttr::MARGIN))
+      margin = ntag->intValue(CQXmlAttr::MARGIN);
+    if (ntag->hasNameValue(CQXmlAttr::SPACING))
+      spacing = ntag->intValue(CQXmlAttr::SPACING);
+
+    if (l->margin () != margin ) l->setMargin (margin );
+    if (l->spacing() != spacing) l->setSpacing(spacing);
+
+    nlayoutTag->setLayout(l);
+
+    if (! reloadChildren(state, otag, ntag, nullptr, l))
+      return false;
+
+    if (olayoutTag->columnStretches() != nlayoutTag->columnStretches() ||
+        olayoutTag->rowStretches   () != nlayoutTag->rowStretches   ()) {
+      auto *grid = qobject_cast<QGridLayout *>(l);
+
+      if (grid) {
+        for (const auto &ipair : olayoutTag->columnStretches())
+          grid->setColumnStretch(ipair.first, 0);
+
+        for (const auto &ipair : olayoutTag->rowStretches())
+          grid->setRowStretch(ipair.first, 0);
+      }
+
+      nlayoutTag->endLayout();
+    }
+
+    return true;
+  }
+  else {
+    if (! isSameTag(otag, ntag))
+      return false;
+
+    ntag->setObject(obj);
+
+    return true;
+  }
+}
+
+// create objects for new tag (and children) and move before next sibling's object
+void
+CQXml::
+reloadBuild(CQXmlReloadState &state, CQXmlTag *ptag, CQXmlTag *tag,
+            QWidget *widget, QLayout *layout, QObject *before)
+{
+  CQXmlTraceScope trace(trace_, tag->getName().c_str(),
+                        trace_ ? state.factory->traceArg(tag) : QString());
+
+  QWidget *widget1 = nullptr;
+  QLayout *layout1 = nullptr;
+
+  state.factory->createChild(ptag, tag, widget, layout, widget1, layout1);
+
+  state.factory->createChildWidgets(tag, widget1, layout1);
+
+  state.built.insert(tag);
+
+  QStringList names;
+
+  tag->addNames(names);
+
+  for (const auto &name : names)
+    state.names.insert(name);
+
+  auto *obj = tag->object();
+
+  if (obj && before)
+    reloadMove(widget, layout, obj, before);
+}
+
+// re-run exec tags (outside created subtrees) which reference created objects
+void
+CQXml::
+reloadExec(CQXmlReloadState &state, CQXmlTag *ptag, CQXmlTag *tag)
+{
+  if (state.built.find(tag) != state.built.end())
+    return;
+
+  if (tag->isExec()) {
+    if (! state.names.contains(tag->nameValue(CQXmlAttr::SOURCE)) &&
+        ! state.names.contains(tag->nameValue(CQXmlAttr::DEST)) &&
+        ! state.names.contains(tag->nameValue(CQXmlAttr::PROPERTY_WIDGET)))
+      return;
+
+    auto *widget = (ptag ? qobject_cast<QWidget *>(ptag->object()) : nullptr);
+    auto *layout = (ptag ? qobject_cast<QLayout *>(ptag->object()) : nullptr);
+
+    (void) tag->exec(widget, layout);
+
+    return;
+  }
+
+  for (auto *tag1 : childTags(tag))
+    reloadExec(state, tag, tag1);
+}
+
+// delete objects of tag and its children
+void
+CQXml::
+destroyTag(CQXmlReloadState &state, CQXmlTag *tag)
+{
+  // widgets of deferred record will not be needed
+  auto pd = state.deferred.find(tag);
+
+  if (pd != state.deferred.end()) {
+    removeDeferred((*pd).second);
+
+    state.deferred.erase(pd);
+  }
+
+  // children first as layout does not own widgets of its items
+  for (auto *tag1 : childTags(tag))
+    destroyTag(state, tag1);
+
+  auto *obj = tag->object();
+  if (! obj) return;
+
+  if (tag->hasNameValue(CQXmlAttr::NAME)) {
+    auto name = tag->nameValue(CQXmlAttr::NAME);
+
+    // name may already refer to object created for new tag
+    auto pw = widgets_.find(name);
+
+    if (pw != widgets_.end() && (*pw).second == obj)
+      widgets_.erase(pw);
+
+    auto pl = layouts_.find(name);
+
+    if (pl != layouts_.end() && (*pl).second == obj)
+      layouts_.erase(pl);
+  }
+
+  delete obj;
+}
+
+void
+CQXml::
+addTemplate(const QString &key, CQXmlTemplate *tmpl)
+{
+  auto p = templates_.find(key);
+
+  if (p != templates_.end()) {
+    auto *tmpl1 = (*p).second;
+
+    retireTree(tmpl1->xml, tmpl1->factory);
+
+    tmpl1->xml = nullptr;
+
+    delete tmpl1;
+  }
+
+  templates_[key] = tmpl;
+
+  template_ = tmpl;
+}
+
+void
+CQXml::
+clearTemplateCache()
+{
+  for (auto &pt : templates_) {
+    auto *tmpl = pt.second;
+
+    retireTree(tmpl->xml, tmpl->factory);
+
+    tmpl->xml = nullptr;
+
+    delete tmpl;
+  }
+
+  templates_.clear();
+
+  template_ = nullptr;
+}
+
+bool
+CQXml::
+compile(const std::string &filename, const std::string &binaryFilename)
+{
+  QFile file(filename.c_str());
+
+  if (! file.open(QIODevice::ReadOnly))
+    return false;
+
+  QXmlStreamReader reader(&file);
+
+  CQXmlBinaryWriter writer(this);
+
+  if (! writer.read(reader))
+    return false;
+
+  return writer.write(binaryFilename);
+}
+
+bool
+CQXml::
+createWidgetsFromBinary(QWidget *parent, const std::string &filename)
+{
+  parent_ = parent;
+
+  template_ = nullptr;
+
+  filename_.clear();
+  fileTree_ = false;
+
+  if (watchFile_)
+    updateWatch();
+
+  QFile file(filename.c_str());
+
+  if (! file.open(QIODevice::ReadOnly))
+    return false;
+
+  auto size = file.size();
+
+  auto *data = file.map(0, size);
+
+  if (! data)
+    return false;
+
+  // tags are deleted when built so nothing can be deferred
+  resetTree();
+
+  factory_->setDeferAllowed(false);
+
+  CQXmlBinaryReader reader(this, parent);
+
+  bool rc = reader.read(data, size);
+
+  factory_->setDeferAllowed(true);
+
+  file.unmap(data);
+
+  if (! rc)
+    std::cerr << "Invalid compiled form '" << filename << "'" << std::endl;
+
+  return rc;
+}
+
+bool
+CQXml::
+streamWidgets(QXmlStreamReader &reader)
+{
+  // tags are deleted when built so nothing can be deferred
+  resetTree();
+
+  factory_->setDeferAllowed(false);
+
+  CQXmlStreamBuilder builder(this, parent_);
+
+  bool rc = builder.read(reader);
+
+  factory_->setDeferAllowed(true);
+
+  return rc;
+}
+
+void
+CQXml::
+addLayout(const QString &name, QLayout *l)
+{
+  layouts_[name] = l;
+}
+
+QLayout *
+CQXml::
+getLayout(const QString &name) const
+{
+  auto p = layouts_.find(name);
+
+  if (p == layouts_.end()) {
+    // name may be defined in widgets not yet created
+    if (! const_cast<CQXml *>(this)->buildDeferredName(name))
+      return nullptr;
+
+    return getLayout(name);
+  }
+
+  return (*p).second;
+}
+
+void
+CQXml::
+addWidget(const QString &name, QWidget *w)
+{
+  widgets_[name] = w;
+}
+
+QWidget *
+CQXml::
+getWidget(const QString &name) const
+{
+  auto p = widgets_.find(name);
+
+  if (p == widgets_.end()) {
+    if (! const_cast<CQXml *>(this)->buildDeferredName(name))
+      return nullptr;
+
+    return getWidget(name);
+  }
+
+  return (*p).second;
+}
+
+void
+CQXml::
+addAction(const QString &name, QAction *w)
+{
+  actions_[name] = w;
+}
+
+QAction *
+CQXml::
+getAction(const QString &name) const
+{
+  auto p = actions_.find(name);
+
+  if (p == actions_.end()) {
+    if (! const_cast<CQXml *>(this)->buildDeferredName(name))
+      return nullptr;
+
+    return getAction(name);
+  }
+
+  return (*p).second;
+}
+
+void
+CQXml::
+addDeferred(CQXmlDeferred *deferred)
+{
+  deferred_.insert(deferred);
+
+  // tag tree must outlive record
+  ++treeRefs_[deferred->factory];
+}
+
+void
+CQXml::
+removeDeferred(CQXmlDeferred *deferred)
+{
+  auto p = deferred_.find(deferred);
+  if (p == deferred_.end()) return;
+
+  deferred_.erase(p);
+
+  if (deferred->item)
+    deferred->item->setDeferred(nullptr);
+
+  releaseTree(deferred->factory);
+
+  delete deferred;
+}
+
+void
+CQXml::
+buildDeferred()
+{
+  // building may add nested deferred widgets so loop until none left
+  while (! deferred_.empty())
+    buildDeferred(*deferred_.begin());
+}
+
+void
+CQXml::
+startBuild(CQXmlFactory *factory, QWidget *parent)
+{
+  buildFactory_ = factory;
+  buildParent_  = parent;
+
+  if (! buildTimer_) {
+    buildTimer_ = new QTimer(this);
+
+    buildTimer_->setSingleShot(true);
+
+    connect(buildTimer_, SIGNAL(timeout()), this, SLOT(buildTimerSlot()));
+  }
+
+  Q_EMIT buildProgress(0, factory->numBuildTags());
+
+  buildTimer_->start(0);
+}
+
+void
+CQXml::
+finishBuild()
+{
+  // not from inside build slice (e.g. widget lookup by tag being created)
+  if (! buildFactory_ || buildStepping_)
+    return;
+
+  buildTimer_->stop();
+
+  if (buildParent_)
+    buildFactory_->finishBuild();
+  else
+    buildFactory_->cancelBuild();
+
+  endBuild();
+}
+
+void
+CQXml::
+buildTimerSlot()
+{
+  if (! buildFactory_)
+    return;
+
+  // parent deleted during build
+  if (! buildParent_) {
+    buildFactory_->cancelBuild();
+
+    endBuild();
+
+    return;
+  }
+
+  QElapsedTimer timer;
+
+  timer.start();
+
+  buildStepping_ = true;
+
+  while (buildFactory_->buildStep() && timer.elapsed() < buildSlice_)
+    ;
+
+  buildStepping_ = false;
+
+  if (! buildFactory_->isBuilding()) {
+    endBuild();
+    return;
+  }
+
+  Q_EMIT buildProgress(buildFactory_->numBuiltTags(), buildFactory_->numBuildTags());
+
+  // let paint and input events run before next slice
+  buildTimer_->start(0);
+}
+
+void
+CQXml::
+endBuild()
+{
+  int n = buildFactory_->numBuildTags();
+
+  buildFactory_ = nullptr;
+  buildParent_  = nullptr;
+
+  Q_EMIT buildProgress(n, n);
+
+  Q_EMIT buildFinished();
+}
+
+bool
+CQXml::
+buildDeferredName(const QString &name)
+{
+  // name may be defined by tags not yet reached by incremental build
+  if (buildFactory_ && ! buildStepping_) {
+    finishBuild();
+    return true;
+  }
+
+  for (auto *deferred : deferred_) {
+    if (deferred->names.contains(name)) {
+      buildDeferred(deferred);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+CQXml::
+buildDeferred(CQXmlDeferred *deferred)
+{
+  auto p = deferred_.find(deferred);
+  if (p == deferred_.end()) return;
+
+  // remove first as build can add (or build) other deferred widgets
+  deferred_.erase(p);
+
+  using Type = CQXmlDeferred::Type;
+
+  CQXmlTraceScope trace(trace_, deferred->tag->getName().c_str(),
+                        trace_ ? QString("deferred") : QString());
+
+  auto *widget = deferred->widget.data();
+
+  if      (deferred->type == Type::PAGE) {
+    auto *parent = deferred->parent.data();
+
+    if (widget && parent) {
+      auto *w1 = deferred->tag->createWidgetChild(parent, deferred->ptag);
+
+      // page is looked up (by name or index) as itself, not inside placeholder
+      bool current = CQXmlUtil::replacePage(parent, widget, w1);
+
+      deferred->factory->createWidgets(deferred->tag, w1);
+
+      // built from currentChanged so listeners may have seen the placeholder as current
+      if (current)
+        CQXmlUtil::emitCurrentChanged(parent);
+    }
+  }
+  else if (deferred->type == Type::DIALOG) {
+    auto *wtag = dynamic_cast<CQXmlQtWidgetTag *>(deferred->tag);
+
+    if (wtag) {
+      auto *w1 = wtag->createDialog();
+
+      deferred->factory->createWidgets(deferred->tag, w1);
+
+      // as when created at load
+      w1->show();
+    }
+  }
+  else if (deferred->type == Type::ITEM) {
+    auto *item = deferred->item;
+
+    if (widget && item) {
+      item->setDeferred(nullptr);
+
+      item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+
+      deferred->factory->createTreeItems(deferred->tag, widget, item);
+    }
+  }
+  else {
+    if (widget)
+      deferred->factory->createWidgets(deferred->tag, widget);
+  }
+
+  // after build as nested records can use same tag tree
+  releaseTree(deferred->factory);
+
+  delete deferred;
+}
+
+void
+CQXml::
+buildDeferredWidget(QWidget *widget, CQXmlDeferredType type)
+{
+  if (! widget) return;
+
+  for (auto *deferred : deferred_) {
+    if (deferred->type == type && deferred->widget == widget) {
+      buildDeferred(deferred);
+      break;
+    }
+  }
+}
+
+void
+CQXml::
+deferredPageSlot(int ind)
+{
+  auto *page = CQXmlUtil::pageWidget(qobject_cast<QWidget *>(sender()), ind);
+
+  buildDeferredWidget(page, CQXmlDeferredType::PAGE);
+}
+
+void
+CQXml::
+deferredMenuSlot()
+{
+  buildDeferredWidget(qobject_cast<QWidget *>(sender()), CQXmlDeferredType::MENU);
+}
+
+void
+CQXml::
+deferredDockSlot(bool visible)
+{
+  if (! visible) return;
+
+  buildDeferredWidget(qobject_cast<QWidget *>(sender()), CQXmlDeferredType::DOCK);
+}
+
+void
+CQXml::
+deferredItemSlot(QTreeWidgetItem *item)
+{
+  auto *item1 = dynamic_cast<CQXmlTreeWidgetItem *>(item);
+
+  if (item1 && item1->deferred())
+    buildDeferred(item1->deferred());
+}
+
+void
+CQXml::
+onSlot()
+{
+  auto value = sender()->property("onValue").toString();
+
+  execSlot(value);
+}
+
+void
+CQXml::
+execSlot(const QString &str)
+{
+  std::cout << str.toStdString() << "\n";
+}
+
+//-------
+
+CXMLTag *
+CQXmlFactory::
+createTag(const CXML *xml, CXMLTag *parent, const std::string &name, CXMLTag::OptionArray &options)
+{
+  return createTag(xml, parent, name, options, lookup(name));
+}
+
+CXMLTag *
+CQXmlFactory::
+createTag(const CXML *xml, CXMLTag *parent, const std::string &name,
+          CXMLTag::OptionArray &options, const CQXmlFactoryHandle &handle)
+{
+  using Type = CQXmlFactoryHandle::Type;
+
+  CQXmlStatsTimer timer(stats(), CQXmlStats::Phase::CREATE_TAG, name.c_str());
+
+  CQXmlTag *tag = nullptr;
+
+  if      (handle.type == Type::ROOT) {
+    auto *root = new CQXmlRootTag(parent, xml_, name, options);
+
+    setRoot(root);
+
+    tag = root;
+  }
+  else if (handle.type == Type::TAG)
+    tag = handle.tagFactory->createTag(xml, parent, name, options);
+  else if (handle.type == Type::WIDGET) {
+    auto *wtag = new CQXmlQtWidgetTag(xml, parent, handle.widgetFactory, name, options);
+
+    wtag->setGeneration(handle.generation);
+
+    tag = wtag;
+  }
+  else {
+    std::cerr << "Invalid tag name " << name << std::endl;
+    return CXMLFactory::createTag(xml, parent, name, options);
+  }
+
+  if (tag) {
+    tag->setXml(xml_);
+
+    tag->handleOptions(options);
+  }
+
+  return tag;
+}
+
+QLayout *
+CQXmlFactory::
+initRoot(QWidget *parent)
+{
+  root_->initParent(parent);
+
+  if (! CQXmlUtil::allowLayout(parent))
+    return nullptr;
+
+  return root_->createRootLayout(parent);
+}
+
+void
+CQXmlFactory::
+createWidgets(QWidget *parent)
+{
+  // only one incremental build at a time (tag tree must outlive build)
+  bool incremental = (xml_->isIncrementalBuild() && isDeferAllowed());
+
+  if (incremental)
+    xml_->finishBuild();
+
+  auto *layout = initRoot(parent);
+
+  BuildStack stack;
+
+  if (layout)
+    pushWidgets(stack, root_, layout);
+  else
+    pushWidgets(stack, root_, parent);
+
+  if (incremental) {
+    cancelBuild();
+
+    buildStack_.swap(stack);
+
+    numBuildTags_ = countTags(root_);
+    numBuilt_     = 0;
+
+    xml_->startBuild(this, parent);
+  }
+  else
+    buildAll(stack);
+}
+
+void
+CQXmlFactory::
+createWidgets(CXMLTag *tag, QLayout *layout)
+{
+  BuildStack stack;
+
+  pushWidgets(stack, tag, layout);
+
+  buildAll(stack);
+}
+
+void
+CQXmlFactory::
+createWidgets(CXMLTag *tag, QWidget *widget)
+{
+  BuildStack stack;
+
+  pushWidgets(stack, tag, widget);
+
+  buildAll(stack);
+}
+
+// create object for child tag in parent layout (if non-null) or parent widget and
+// return the widget or layout its own children are added to
+void
+CQXmlFactory::
+createChild(CQXmlTag *ptag, CQXmlTag *tag, QWidget *widget, QLayout *layout,
+            QWidget *&widget1, QLayout *&layout1)
+{
+  widget1 = nullptr;
+  layout1 = nullptr;
+
+  if (layout) {
+    if      (tag->isLayout())
+      layout1 = tag->createLayout(nullptr, layout, ptag);
+    else if (tag->isWidget())
+      widget1 = tag->createLayoutChild(layout, ptag);
+    else if (tag->isExec())
+      (void) tag->exec(nullptr, layout);
+  }
+  else {
+    if      (tag->isLayout()) {
+      layout1 = tag->createLayout(widget, nullptr, ptag);
+
+      if (qobject_cast<QGroupBox *>(widget))
+        qobject_cast<QGroupBox *>(widget)->setLayout(layout1);
+    }
+    else if (tag->isWidget())
+      widget1 = tag->createWidgetChild(widget, ptag);
+    else if (tag->isExec())
+      (void) tag->exec(widget, nullptr);
+  }
+}
+
+void
+CQXmlFactory::
+createChildWidgets(CQXmlTag *tag, QWidget *widget, QLayout *layout)
+{
+  BuildStack stack;
+
+  if (pushChildWidgets(stack, tag, widget, layout))
+    buildAll(stack);
+}
+
+void
+CQXmlFactory::
+createTreeItems(CXMLTag *tag, QWidget *tree, QTreeWidgetItem *item)
+{
+  BuildStack stack;
+
+  pushWidgets(stack, tag, tree);
+
+  stack.back().item = item;
+
+  buildAll(stack);
+}
+
+void
+CQXmlFactory::
+finishBuild()
+{
+  buildAll(buildStack_);
+}
+
+void
+CQXmlFactory::
+cancelBuild()
+{
+  for (auto &frame : buildStack_)
+    delete frame.items;
+
+  buildStack_.clear();
+}
+
+void
+CQXmlFactory::
+pushWidgets(BuildStack &stack, CXMLTag *tag, QLayout *layout)
+{
+  BuildFrame frame;
+
+  frame.tag      = tag;
+  frame.ptag     = dynamic_cast<CQXmlTag *>(tag);
+  frame.layout   = layout;
+  frame.isLayout = true;
+
+  stack.push_back(frame);
+}
+
+void
+CQXmlFactory::
+pushWidgets(BuildStack &stack, CXMLTag *tag, QWidget *widget)
+{
+  BuildFrame frame;
+
+  frame.tag    = tag;
+  frame.ptag   = dynamic_cast<CQXmlTag *>(tag);
+  frame.widget = widget;
+
+  // item tags are collected and added to item widget/view in one step
+  if (isItemBatch(tag, widget))
+    frame.items = new CQXmlItemStore;
+
+  stack.push_back(frame);
+}
+
+// push children of child tag (if any to create)
+bool
+CQXmlFactory::
+pushChildWidgets(BuildStack &stack, CQXmlTag *tag, QWidget *widget, QLayout *layout)
+{
+  if      (tag->isLayout()) {
+    pushWidgets(stack, tag, layout);
+
+    stack.back().endLayout = true;
+
+    return true;
+  }
+  else if (tag->isWidget()) {
+    if (! deferChildren(tag, widget)) {
+      pushWidgets(stack, tag, widget);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// push children of tree item tag (if any to create now) to add to its item
+bool
+CQXmlFactory::
+pushTreeItems(BuildStack &stack, CQXmlTag *tag, QWidget *tree, CQXmlTreeWidgetItem *item)
+{
+  if (! tag->getNumChildren() || deferItems(tag, tree, item))
+    return false;
+
+  pushWidgets(stack, tag, tree);
+
+  stack.back().item = item;
+
+  return true;
+}
+
+// create object of next child tag of top of stack (false when stack is empty)
+bool
+CQXmlFactory::
+buildStep(BuildStack &stack)
+{
+  if (stack.empty())
+    return false;
+
+  auto &frame = stack.back();
+
+  CQXmlTag *tag1 = nullptr;
+
+  while (! tag1 && frame.ind < frame.tag->getNumChildren()) {
+    const auto *token = frame.tag->getChild(int(frame.ind++));
+
+    if (token->isTag())
+      tag1 = dynamic_cast<CQXmlTag *>(token->getTag());
+  }
+
+  if (! tag1) {
+    popBuild(stack);
+
+    return ! stack.empty();
+  }
+
+  ++numBuilt_;
+
+  if (frame.items) {
+    auto *itemTag = dynamic_cast<CQXmlItemTag *>(tag1);
+
+    if (itemTag) {
+      itemTag->addItem(*frame.items);
+      return true;
+    }
+  }
+
+  if (frame.isLayout) {
+    if (deferDialog(frame.ptag, tag1))
+      return true;
+  }
+  else {
+    if (deferPage(frame.ptag, tag1, frame.widget) || deferDialog(frame.ptag, tag1))
+      return true;
+  }
+
+  // trace event of child ends when its children are done
+  auto *trace = xml_->trace();
+
+  if (trace)
+    trace->begin(tag1->getName().c_str(), traceArg(tag1));
+
+  bool pushed = false;
+
+  auto *treeItemTag = dynamic_cast<CQXmlTreeItemTag *>(tag1);
+
+  if (treeItemTag && qobject_cast<QTreeWidget *>(frame.widget)) {
+    auto *tree = frame.widget;
+
+    auto *item = treeItemTag->addTreeItem(qobject_cast<QTreeWidget *>(tree), frame.item);
+
+    // frame reference is invalid after push
+    pushed = pushTreeItems(stack, tag1, tree, item);
+  }
+  else {
+    QWidget *widget1 = nullptr;
+    QLayout *layout1 = nullptr;
+
+    createChild(frame.ptag, tag1, frame.widget, frame.layout, widget1, layout1);
+
+    // frame reference is invalid after push
+    pushed = pushChildWidgets(stack, tag1, widget1, layout1);
+  }
+
+  if (pushed)
+    stack.back().trace = (trace != nullptr);
+  else if (trace)
+    trace->end(tag1->getName().c_str());
+
+  return true;
+}
+
+void
+CQXmlFactory::
+buildAll(BuildStack &stack)
+{
+  while (buildStep(stack))
+    ;
+}
+
+// finish tag whose children have all been created
+void
+CQXmlFactory::
+popBuild(BuildStack &stack)
+{
+  auto frame = stack.back();
+
+  stack.pop_back();
+
+  if (frame.items) {
+    if (frame.items->numRows())
+      applyItems(frame.ptag, frame.widget, *frame.items);
+
+    delete frame.items;
+  }
+
+  if (frame.endLayout) {
+    CQXmlStatsTimer timer(stats(), CQXmlStats::Phase::END_LAYOUT, frame.ptag->getName().c_str());
+
+    frame.ptag->endLayout();
+  }
+
+  // trace may have been stopped during incremental build
+  if (frame.trace && xml_->trace())
+    xml_->trace()->end(frame.ptag->getName().c_str());
+}
+
+int
+CQXmlFactory::
+countTags(CXMLTag *tag) const
+{
+  int n = 0;
+
+  for (size_t i = 0; i < tag->getNumChildren(); ++i) {
+    const auto *token = tag->getChild(int(i));
+
+    if (token->isTag())
+      n += 1 + countTags(token->getTag());
+  }
+
+  return n;
+}
+
+QString
+CQXmlFactory::
+traceArg(CQXmlTag *tag) const
+{
+  if (! xml_->trace() || ! tag->hasNameValue(CQXmlAttr::NAME))
+    return QString();
+
+  return tag->nameValue(CQXmlAttr::NAME);
+}
+
+// check if item tags for widget are added in bulk (always for plain item views which
+// get a read-only model, optional for item widgets)
+bool
+CQXmlFactory::
+isItemBatch(CXMLTag *tag, QWidget *widget) const
+{
+  // nested tree items are added to their parent item (not batched)
+  if (qobject_cast<QTreeWidget *>(widget)) {
+    if (! xml_->isBatchItems() || dynamic_cast<CQXmlTreeItemTag *>(tag))
+      return false;
+
+    for (size_t i = 0; i < tag->getNumChildren(); ++i) {
+      const auto *token = tag->getChild(int(i));
+      if (! token->isTag()) continue;
+
+      auto *itemTag = dynamic_cast<CQXmlTreeItemTag *>(token->getTag());
+
+      if (itemTag && itemTag->getNumChildren())
+        return false;
+    }
+
+    return true;
+  }
+
+  if (qobject_cast<QListWidget *>(widget) || qobject_cast<QTableWidget *>(widget))
+    return xml_->isBatchItems();
+
+  // only plain views (subclasses may have or need own model)
+  const auto *meta = widget->metaObject();
+
+  if (meta != &QListView::staticMetaObject && meta != &QTableView::staticMetaObject &&
+      meta != &QTreeView::staticMetaObject)
+    return false;
+
+  // explicit model is not replaced
+  auto *qtag = dynamic_cast<CQXmlTag *>(tag);
+
+  return (! qtag || ! qtag->hasNameValue(CQXmlAttr::MODEL));
+}
+
+void
+CQXmlFactory::
+applyItems(CQXmlTag *ptag, QWidget *widget, const CQXmlItemStore &store)
+{
+  int nr = store.numRows();
+  int nc = store.numColumns();
+
+  if      (qobject_cast<QListWidget *>(widget)) {
+    auto *list = qobject_cast<QListWidget *>(widget);
+
+    QStringList texts;
+
+    texts.reserve(nr);
+
+    for (int r = 0; r < nr; ++r)
+      texts << store.cell(r, 0);
+
+    list->addItems(texts);
+  }
+  else if (qobject_cast<QTableWidget *>(widget)) {
+    auto *table = qobject_cast<QTableWidget *>(widget);
+
+    bool sorting = table->isSortingEnabled();
+
+    table->setSortingEnabled(false);
+    table->setUpdatesEnabled(false);
+
+    if (table->rowCount   () < nr) table->setRowCount   (nr);
+    if (table->columnCount() < nc) table->setColumnCount(nc);
+
+    // setItem emits dataChanged per cell from the model, so block the model (not the
+    // view) while filling and reset the view once afterwards
+    {
+      QSignalBlocker blocker(table->model());
+
+      for (int c = 0; c < nc; ++c) {
+        for (int r = 0; r < nr; ++r) {
+          const auto &text = store.cell(r, c);
+
+          if (! text.isNull())
+            table->setItem(r, c, new QTableWidgetItem(text));
+        }
+      }
+    }
+
+    table->reset();
+
+    table->setUpdatesEnabled(true);
+    table->setSortingEnabled(sorting);
+  }
+  else if (qobject_cast<QTreeWidget *>(widget)) {
+    auto *tree = qobject_cast<QTreeWidget *>(widget);
+
+    QList<QTreeWidgetItem *> treeItems;
+
+    treeItems.reserve(nr);
+
+    for (int r = 0; r < nr; ++r) {
+      QStringList texts;
+
+      for (int c = 0; c < nc; ++c) {
+        const auto &text = store.cell(r, c);
+        if (text.isNull()) break;
+
+        texts << text;
+      }
+
+      treeItems << new QTreeWidgetItem(texts);
+    }
+
+    tree->addTopLevelItems(treeItems);
+  }
+  else if (qobject_cast<QAbstractItemView *>(widget)) {
+    auto *view = qobject_cast<QAbstractItemView *>(widget);
+
+    QStringList columnLabels, rowLabels;
+
+    if (ptag && ptag->hasNameValue(CQXmlAttr::COLUMN_LABELS))
+      columnLabels = ptag->nameValue(CQXmlAttr::COLUMN_LABELS).split(' ');
+
+    if (ptag && ptag->hasNameValue(CQXmlAttr::ROW_LABELS))
+      rowLabels = ptag->nameValue(CQXmlAttr::ROW_LABELS).split(' ');
+
+    auto *model = new CQXmlItemModel(view, store, columnLabels, rowLabels);
+
+    view->setModel(model);
+  }
+}
+
+// get lazy state from tag's lazy attribute (if any) or default
+bool
+CQXmlFactory::
+isLazy(CQXmlTag *tag, bool lazy) const
+{
+  if (tag && tag->hasNameValue(CQXmlAttr::LAZY))
+    return CQXmlUtil::stringToBool(tag->nameValue(CQXmlAttr::LAZY));
+
+  return lazy;
+}
+
+// add placeholder for non-current page of tab widget, tool box or stacked widget and
+// create the real page when it first becomes current (or is looked up by name)
+bool
+CQXmlFactory::
+deferPage(CQXmlTag *ptag, CQXmlTag *tag, QWidget *widget)
+{
+  if (! isDeferAllowed())
+    return false;
+
+  auto *wtag = dynamic_cast<CQXmlQtWidgetTag *>(tag);
+  if (! wtag) return false;
+
+  // first page is current so always created
+  if (CQXmlUtil::numPages(widget) <= 0)
+    return false;
+
+  if (! isLazy(tag, isLazy(ptag, xml_->isLazyPages())))
+    return false;
+
+  auto *placeholder = new QWidget;
+
+  (void) wtag->addPage(widget, placeholder);
+
+  auto *deferred = addDeferred(CQXmlDeferredType::PAGE, ptag, tag, placeholder);
+
+  deferred->parent = widget;
+
+  // placeholder represents page in parent until it is built (e.g. for reload)
+  tag->setObject(placeholder);
+
+  QObject::connect(widget, SIGNAL(currentChanged(int)), xml_, SLOT(deferredPageSlot(int)),
+                   Qt::UniqueConnection);
+
+  return true;
+}
+
+// skip creation of dialog until it is looked up by name
+bool
+CQXmlFactory::
+deferDialog(CQXmlTag *ptag, CQXmlTag *tag)
+{
+  if (! isDeferAllowed())
+    return false;
+
+  if (! dynamic_cast<CQXmlQtWidgetTag *>(tag) || ! CQXmlUtil::isDialogName(tag->getName()))
+    return false;
+
+  // created on lookup by name so unnamed dialog can't be deferred
+  if (! tag->hasNameValue(CQXmlAttr::NAME))
+    return false;
+
+  if (! isLazy(tag, xml_->isLazyDialogs()))
+    return false;
+
+  (void) addDeferred(CQXmlDeferredType::DIALOG, ptag, tag, nullptr);
+
+  return true;
+}
+
+// create menu contents when menu is about to be shown and dock widget contents
+// when dock widget is first visible
+bool
+CQXmlFactory::
+deferChildren(CQXmlTag *tag, QWidget *widget)
+{
+  using Type = CQXmlDeferred::Type;
+
+  if (! isDeferAllowed() || ! widget || ! tag->getNumChildren())
+    return false;
+
+  if      (qobject_cast<QMenu *>(widget)) {
+    if (! isLazy(tag, xml_->isLazyMenus()))
+      return false;
+
+    (void) addDeferred(Type::MENU, nullptr, tag, widget);
+
+    QObject::connect(widget, SIGNAL(aboutToShow()), xml_, SLOT(deferredMenuSlot()),
+                     Qt::UniqueConnection);
+  }
+  else if (qobject_cast<QDockWidget *>(widget)) {
+    if (! isLazy(tag, xml_->isLazyDocks()))
+      return false;
+
+    (void) addDeferred(Type::DOCK, nullptr, tag, widget);
+
+    QObject::connect(widget, SIGNAL(visibilityChanged(bool)), xml_, SLOT(deferredDockSlot(bool)),
+                     Qt::UniqueConnection);
+  }
+  else
+    return false;
+
+  return true;
+}
+
+// create child items of tree item when item is first expanded
+bool
+CQXmlFactory::
+deferItems(CQXmlTag *tag, QWidget *tree, CQXmlTreeWidgetItem *item)
+{
+  if (! isDeferAllowed() || ! isLazy(tag, xml_->isLazyTreeItems()))
+    return false;
+
+  auto *deferred = addDeferred(CQXmlDeferredType::ITEM, nullptr, tag, tree);
+
+  deferred->item = item;
+
+  item->setDeferred(deferred);
+
+  item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+
+  QObject::connect(tree, SIGNAL(itemExpanded(QTreeWidgetItem*)),
+                   xml_, SLOT(deferredItemSlot(QTreeWidgetItem*)), Qt::UniqueConnection);
+
+  return true;
+}
+
+CQXmlDeferred *
+CQXmlFactory::
+addDeferred(CQXmlDeferredType type, CQXmlTag *ptag, CQXmlTag *tag, QWidget *widget)
+{
+  auto *deferred = new CQXmlDeferred;
+
+  deferred->type    = type;
+  deferred->factory = this;
+  deferred->ptag    = ptag;
+  deferred->tag     = tag;
+  deferred->widget  = widget;
+
+  // tree items have no named objects (skip for large trees)
+  if (deferred->type != CQXmlDeferred::Type::ITEM)
+    tag->addNames(deferred->names);
+
+  xml_->addDeferred(deferred);
+
+  return deferred;
+}
+
+//------
+
+const CQXmlPropertyPlan &
+CQXmlPropertyPlan::
+get(const QMetaObject *meta, int nameId)
+{
+  // std::map so returned references stay valid as plans are added
+  using NamePlans = std::map<int, CQXmlPropertyPlan>;
+  using MetaPlans = std::map<const QMetaObject *, NamePlans>;
+
+  static MetaPlans metaPlans;
+  static QMutex    mutex;
+
+  // plans are also resolved by worker thread of createWidgetsAsync so shared plans
+  // are locked. Each thread keeps its own index of plans it has used so only the
+  // first use of a plan in a thread takes the lock
+  using PlanKey  = QPair<const QMetaObject *, int>;
+  using PlanPtrs = QHash<PlanKey, const CQXmlPropertyPlan *>;
+
+  thread_local PlanPtrs planPtrs;
+
+  auto pp = planPtrs.find(PlanKey(meta, nameId));
+
+  if (pp != planPtrs.end())
+    return *pp.value();
+
+  QMutexLocker locker(&mutex);
+
+  auto &namePlans = metaPlans[meta];
+
+  auto p = namePlans.find(nameId);
+
+  if (p != namePlans.end()) {
+    planPtrs[PlanKey(meta, nameId)] = &(*p).second;
+
+    return (*p).second;
+  }
+
+  CQXmlPropertyPlan plan;
+
+  int propIndex = meta->indexOfProperty(CQXmlAttr::name(nameId).toLatin1());
+
+  if (propIndex >= 0) {
+    plan.prop  = meta->property(propIndex);
+    plan.valid = plan.prop.isWritable();
+    plan.type  = int(plan.prop.type());
+
+    if (plan.prop.isEnumType()) {
+      plan.isEnum = true;
+
+      auto me = plan.prop.enumerator();
+
+      for (int i = 0; i < me.keyCount(); ++i)
+        plan.enumValues[me.key(i)] = me.value(i);
+    }
+  }
+
+  const auto &plan1 = (*namePlans.insert(std::make_pair(nameId, plan)).first).second;
+
+  planPtrs[PlanKey(meta, nameId)] = &plan1;
+
+  return plan1;
+}
+
+//------
+
+CQXmlStreamBuilder::
+CQXmlStreamBuilder(CQXml *xml, QWidget *parent) :
+ xml_(xml), parent_(parent)
+{
+}
+
+CQXmlStreamBuilder::
+~CQXmlStreamBuilder()
+{
+  // only left with open tags on error
+  while (! entries_.empty()) {
+    delete entries_.back().items;
+    delete entries_.back().tag;
+
+    entries_.pop_back();
+  }
+
+  xml_->getFactory()->setRoot(nullptr);
+}
+
+bool
+CQXmlStreamBuilder::
+read(QXmlStreamReader &reader)
+{
+  while (! reader.atEnd()) {
+    auto type = reader.readNext();
+
+    if      (type == QXmlStreamReader::StartElement) {
+      (void) startTag(reader.name().toString().toStdString());
+
+      for (const auto &attr : reader.attributes())
+        addNameValue(attr.name().toString(), attr.value().toString());
+    }
+    else if (type == QXmlStreamReader::EndElement)
+      endTag();
+    else if (type == QXmlStreamReader::Characters) {
+      if (! reader.isWhitespace())
+        addText(reader.text().toString());
+    }
+  }
+
+  if (reader.hasError()) {
+    std::cerr << "XML error: " << reader.errorString().toStdString() <<
+                 " at line " << reader.lineNumber() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+CQXmlTag *
+CQXmlStreamBuilder::
+startTag(const std::string &name)
+{
+  return startTag(name, xml_->lookupFactory(name));
+}
+
+CQXmlTag *
+CQXmlStreamBuilder::
+startTag(const std::string &name, const CQXmlFactoryHandle &handle)
+{
+  CXMLTag *parent = nullptr;
+
+  // parent must exist before child can be added to it
+  if (! entries_.empty()) {
+    buildEntry(entries_.size() - 1);
+
+    parent = entries_.back().tag;
+  }
+
+  CXMLTag::OptionArray options;
+
+  Entry entry;
+
+  entry.tag  = xml_->getFactory()->createTag(xml_->getXml(), parent, name, options, handle);
+  entry.qtag = dynamic_cast<CQXmlTag *>(entry.tag);
+
+  if (! entries_.empty())
+    entry.skip = (! entry.qtag || entries_.back().skip);
+  else
+    entry.skip = (! entry.qtag || ! entry.qtag->isRoot());
+
+  entries_.push_back(entry);
+
+  return entry.qtag;
+}
+
+void
+CQXmlStreamBuilder::
+addNameValue(const QString &name, const QString &value)
+{
+  assert(! entries_.empty());
+
+  auto *qtag = entries_.back().qtag;
+
+  if (qtag)
+    qtag->addNameValue(name, value);
+}
+
+void
+CQXmlStreamBuilder::
+addNameValue(int id, const QString &name, const QString &value, int numInts,
+             const int ints[2])
+{
+  assert(! entries_.empty());
+
+  auto *qtag = entries_.back().qtag;
+  if (! qtag) return;
+
+  qtag->addNameValue(id, name, value);
+
+  if (numInts)
+    qtag->setNameInts(id, numInts, ints);
+}
+
+void
+CQXmlStreamBuilder::
+addText(const QString &text)
+{
+  assert(! entries_.empty());
+
+  auto &entry = entries_.back();
+
+  if (! entry.qtag)
+    return;
+
+  entry.qtag->addText(text);
+
+  // widget already created for earlier child so reapply full text at end tag
+  if (entry.built && ! entry.skip)
+    entry.lateText = true;
+}
+
+void
+CQXmlStreamBuilder::
+endTag()
+{
+  assert(! entries_.empty());
+
+  buildEntry(entries_.size() - 1);
+
+  auto entry = entries_.back();
+
+  entries_.pop_back();
+
+  if (entry.items) {
+    if (entry.items->numRows())
+      xml_->getFactory()->applyItems(entry.qtag, entry.widget, *entry.items);
+
+    delete entry.items;
+  }
+
+  if (entry.lateText && entry.widget) {
+    auto *wtag = dynamic_cast<CQXmlQtWidgetTag *>(entry.qtag);
+
+    if (wtag)
+      wtag->applyText(entry.widget, entry.qtag->getText());
+  }
+
+  if (! entry.skip && entry.qtag->isLayout())
+    entry.qtag->endLayout();
+
+  if (entry.qtag && entry.qtag->isRoot())
+    xml_->getFactory()->setRoot(nullptr);
+
+  delete entry.tag;
+}
+
+void
+CQXmlStreamBuilder::
+buildEntry(size_t i)
+{
+  auto &entry = entries_[i];
+
+  if (entry.built)
+    return;
+
+  entry.built = true;
+
+  if (entry.skip)
+    return;
+
+  if (entry.qtag->isRoot()) {
+    entry.widget = parent_;
+    entry.layout = xml_->getFactory()->initRoot(parent_);
+    return;
+  }
+
+  const auto &pentry = entries_[i - 1];
+
+  // item of batched widget is added to store (its text is complete at end tag)
+  if (pentry.items) {
+    auto *itemTag = dynamic_cast<CQXmlItemTag *>(entry.qtag);
+
+    if (itemTag) {
+      itemTag->addItem(*pentry.items);
+
+      entry.skip = true;
+
+      return;
+    }
+  }
+
+  // nested tree items are added to item of parent tree item
+  auto *treeItemTag = dynamic_cast<CQXmlTreeItemTag *>(entry.qtag);
+
+  if (treeItemTag && qobject_cast<QTreeWidget *>(pentry.widget)) {
+    entry.widget = pentry.widget;
+    entry.item   = treeItemTag->addTreeItem(qobject_cast<QTreeWidget *>(pentry.widget),
+                                            pentry.item);
+    return;
+  }
+
+  auto *factory = xml_->getFactory();
+
+  factory->createChild(pentry.qtag, entry.qtag, pentry.widget, pentry.layout,
+                       entry.widget, entry.layout);
+
+  // same as CQXmlFactory::pushWidgets but tree widget items are added as they are
+  // read as it is not yet known if they have child items
+  if (entry.widget && dynamic_cast<CQXmlQtWidgetTag *>(entry.qtag) &&
+      ! qobject_cast<QTreeWidget *>(entry.widget) &&
+      factory->isItemBatch(entry.tag, entry.widget))
+    entry.items = new CQXmlItemStore;
+}
+
+//------
+
+bool
+CQXmlBinaryWriter::
+read(QXmlStreamReader &reader)
+{
+  using namespace CQXmlBinary;
+
+  while (! reader.atEnd()) {
+    auto type = reader.readNext();
+
+    if      (type == QXmlStreamReader::StartElement) {
+      auto attrs = reader.attributes();
+
+      words_.push_back(START_TAG);
+      words_.push_back(nameId(reader.name().toString()));
+      words_.push_back(uint32_t(attrs.size()));
+
+      for (const auto &attr : attrs) {
+        auto name  = attr.name ().toString();
+        auto value = attr.value().toString();
+
+        words_.push_back(stringId(name ));
+        words_.push_back(stringId(value));
+
+        // numeric value stored parsed so no conversion is needed at load
+        int ints[2];
+
+        int n = CQXmlAttr::parseInts(CQXmlAttr::find(name), value, ints);
+
+        words_.push_back(uint32_t(n));
+
+        for (int j = 0; j < n; ++j)
+          words_.push_back(uint32_t(ints[j]));
+      }
+    }
+    else if (type == QXmlStreamReader::EndElement)
+      words_.push_back(END_TAG);
+    else if (type == QXmlStreamReader::Characters) {
+      if (! reader.isWhitespace()) {
+        words_.push_back(TEXT);
+        words_.push_back(stringId(reader.text().toString()));
+      }
+    }
+  }
+
+  if (reader.hasError()) {
+    std::cerr << "XML error: " << reader.errorString().toStdString() <<
+                 " at line " << reader.lineNumber() << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool
+CQXmlBinaryWriter::
+write(const std::string &filename) const
+{
+  using namespace CQXmlBinary;
+
+  QFile file(filename.c_str());
+
+  if (! file.open(QIODevice::WriteOnly))
+    return false;
+
+  Words index;
+
+  uint32_t numChars = 0;
+
+  for (const auto &str : strings_) {
+    index.push_back(numChars);
+    index.push_back(uint32_t(str.size()));
+
+    numChars += uint32_t(str.size());
+  }
+
+  Header header;
+
+  header.magic      = magic;
+  header.version    = version;
+  header.numStrings = uint32_t(strings_.size());
+  header.numNames   = uint32_t(names_.size()/2);
+  header.numWords   = uint32_t(words_.size());
+  header.numChars   = numChars;
+
+  auto writeWords = [&](const Words &words) {
+    file.write(reinterpret_cast<const char *>(words.data()), qint64(words.size()*sizeof(uint32_t)));
+  };
+
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  writeWords(index);
+  writeWords(names_);
+  writeWords(words_);
+
+  for (const auto &str : strings_)
+    file.write(reinterpret_cast<const char *>(str.utf16()), qint64(str.size()*sizeof(ushort)));
+
+  return (file.error() == QFileDevice::NoError);
+}
+
+uint32_t
+CQXmlBinaryWriter::
+stringId(const QString &str)
+{
+  auto p = stringIds_.find(str);
+
+  if (p != stringIds_.end())
+    return p.value();
+
+  auto id = uint32_t(strings_.size());
+
+  strings_.push_back(str);
+
+  stringIds_[str] = id;
+
+  return id;
+}
+
+uint32_t
+CQXmlBinaryWriter::
+nameId(const QString &name)
+{
+  auto p = nameIds_.find(name);
+
+  if (p != nameIds_.end())
+    return p.value();
+
+  auto id = uint32_t(names_.size()/2);
+
+  names_.push_back(stringId(name));
+  names_.push_back(uint32_t(xml_->lookupFactory(name.toStdString()).type));
+
+  nameIds_[name] = id;
+
+  return id;
+}
+
+//------
+
+bool
+CQXmlBinaryReader::
+read(const uchar *data, qint64 size)
+{
+  using namespace CQXmlBinary;
+
+  if (size < qint64(sizeof(Header)))
+    return false;
+
+  const auto *header = reinterpret_cast<const Header *>(data);
+
+  if (header->magic != magic || header->version != version)
+    return false;
+
+  auto numStrings = header->numStrings;
+  auto numNames   = header->numNames;
+  auto numWords   = header->numWords;
+  auto numChars   = header->numChars;
+
+  qint64 numIndexWords = 2*qint64(numStrings) + 2*qint64(numNames) + qint64(numWords);
+
+  if (size < qint64(sizeof(Header)) + numIndexWords*4 + qint64(numChars)*2)
+    return false;
+
+  const auto *index = reinterpret_cast<const uint32_t *>(data + sizeof(Header));
+  const auto *names = index + 2*numStrings;
+  const auto *words = names + 2*numNames;
+  const auto *chars = reinterpret_cast<const QChar *>(words + numWords);
+
+  //---
+
+  for (uint32_t i = 0; i < numStrings; ++i) {
+    if (qint64(index[2*i]) + index[2*i + 1] > numChars)
+      return false;
+  }
+
+  // names are only used while reading so are viewed in place in the mapped table
+  auto view = [&](uint32_t id) {
+    return QString::fromRawData(chars + index[2*id], int(index[2*id + 1]));
+  };
+
+  // values can be kept by tags and widgets after the file is unmapped so are copied,
+  // once per distinct string (tags share the copy)
+  std::vector<QString> values(numStrings);
+  std::vector<bool>    copied(numStrings);
+
+  auto value = [&](uint32_t id) -> const QString & {
+    if (! copied[id]) {
+      values[id] = QString(chars + index[2*id], int(index[2*id + 1]));
+      copied[id] = true;
+    }
+
+    return values[id];
+  };
+
+  // attribute name id is interned once per distinct name (-2 if not yet looked up)
+  std::vector<int> attrIds(numStrings, -2);
+
+  auto attrId = [&](uint32_t id) {
+    if (attrIds[id] == -2) {
+      auto name = view(id);
+
+      attrIds[id] = CQXmlAttr::find(name);
+
+      // intern table keeps name so it must not be a view
+      if (attrIds[id] < 0)
+        attrIds[id] = CQXmlAttr::id(QString(name.constData(), name.length()));
+    }
+
+    return attrIds[id];
+  };
+
+  // factory is resolved once per distinct tag name, not per tag
+  struct TagName {
+    std::string        name;
+    CQXmlFactoryHandle handle;
+  };
+
+  std::vector<TagName> tagNames(numNames);
+
+  for (uint32_t i = 0; i < numNames; ++i) {
+    auto id = names[2*i];
+
+    if (id >= numStrings)
+      return false;
+
+    auto &tagName = tagNames[i];
+
+    tagName.name   = view(id).toStdString();
+    tagName.handle = xml_->lookupFactory(tagName.name);
+
+    // registered factories changed since compile
+    if (tagName.handle.type != CQXmlFactoryHandle::Type(names[2*i + 1]))
+      std::cerr << "Tag type changed since compile for " << tagName.name << std::endl;
+  }
+
+  //---
+
+  CQXmlStreamBuilder builder(xml_, parent_);
+
+  uint32_t i     = 0;
+  int      depth = 0;
+
+  while (i < numWords) {
+    auto op = words[i++];
+
+    if      (op == START_TAG) {
+      if (i + 2 > numWords)
+        return false;
+
+      auto id = words[i++];
+      auto na = words[i++];
+
+      if (id >= numNames)
+        return false;
+
+      (void) builder.startTag(tagNames[id].name, tagNames[id].handle);
+
+      ++depth;
+
+      for (uint32_t j = 0; j < na; ++j) {
+        if (qint64(i) + 3 > numWords)
+          return false;
+
+        auto nameId  = words[i++];
+        auto valueId = words[i++];
+        auto numInts = words[i++];
+
+        if (nameId >= numStrings || valueId >= numStrings || numInts > 2 ||
+            qint64(i) + numInts > numWords)
+          return false;
+
+        int ints[2] = { 0, 0 };
+
+        for (uint32_t k = 0; k < numInts; ++k)
+          ints[k] = int(words[i++]);
+
+        builder.addNameValue(attrId(nameId), view(nameId), value(valueId), int(numInts),
+                             ints);
+      }
+    }
+    else if (op == TEXT) {
+      if (i + 1 > numWords || depth == 0)
+        return false;
+
+      auto id = words[i++];
+
+      if (id >= numStrings)
+        return false;
+
+      builder.addText(value(id));
+    }
+    else if (op == END_TAG) {
+      if (depth == 0)
+        return false;
+
+      builder.endTag();
+
+      --depth;
+    }
+    else
+      return false;
+  }
+
+  return (depth == 0);
+}
+
+//------
+
+// generates C++ class which creates the widgets of a parsed tag tree directly. Walks
+// the tags in the same order as CQXmlFactory::createWidgets and emits the calls the
+// tag classes would make at runtime (properties are resolved to typed setters)
+class CQXmlCodeGen {
+ public:
+  CQXmlCodeGen(const QString &className, const QString &filename) :
+   className_(className), filename_(filename) {
+  }
+
+  void generate(CQXmlRootTag *root);
+
+  bool write(const QString &headerFilename, const QString &sourceFilename) const;
+
+ private:
+  struct Var {
+    QString            name;
+    const QMetaObject* meta { nullptr };
+
+    bool isValid() const { return ! name.isEmpty(); }
+  };
+
+  void genChildren(CQXmlTag *tag, const Var &widget, const Var &layout);
+
+  void genChild(CQXmlTag *ptag, CQXmlTag *tag, const Var &widget, const Var &layout,
+                Var &widget1, Var &layout1);
+
+  Var genLayout(CQXmlLayoutTag *tag, const Var &widget, const Var &layout);
+
+  void genEndLayout(CQXmlLayoutTag *tag, const Var &layout);
+
+  Var genWidget(CQXmlQtWidgetTag *tag);
+
+  void genLayoutChild(CQXmlQtWidgetTag *tag, const Var &w, const Var &layout);
+  void genWidgetChild(CQXmlQtWidgetTag *tag, const Var &w, const Var &parent);
+
+  void genItem(CQXmlTag *ptag, CQXmlTag *tag, const Var &widget, Var &widget1);
+
+  void genExec(CQXmlTag *tag, const Var &widget);
+
+  Var newVar(const QMetaObject *meta);
+
+  void addMember(const QString &name, const Var &var);
+
+  Var namedVar(const QString &name) const;
+
+  const QMetaObject *widgetMeta(CQXmlQtWidgetTag *tag);
+
+  static bool inherits(const Var &var, const QMetaObject &meta);
+
+  static QString layoutClass(CQXmlUtil::LayoutType type);
+
+  static const QMetaObject *layoutMeta(CQXmlUtil::LayoutType type);
+
+  QString newLayoutCode(CQXmlUtil::LayoutType type, const QString &dir, const QString &parent);
+
+  static QString literal(const QString &str);
+  static QString listLiteral(const QStringList &strs);
+
+  QString iconCode(const QString &filename) const;
+
+  void line(const QString &str) { body_ << "  " + str; }
+
+  void addInclude(const QString &className);
+
+ private:
+  struct Member {
+    QString name;
+    QString className;
+  };
+
+  using Members  = std::vector<Member>;
+  using NamedVar = std::map<QString, Var>;
+  using Counts   = std::map<QString, int>;
+  using ItemVars = std::map<CQXmlTag *, QString>;
+  using Metas    = std::map<CQXmlWidgetFactory *, const QMetaObject *>;
+  using Includes = std::set<QString>;
+
+  QString     className_;
+  QString     filename_;
+  QStringList body_;
+  Members     members_;
+  NamedVar    namedVars_;
+  Counts      counts_;
+  ItemVars    itemVars_;
+  Metas       metas_;
+  Includes    includes_;
+};
+
+void
+CQXmlCodeGen::
+generate(CQXmlRootTag *root)
+{
+  Var parent;
+
+  parent.name = "parent";
+  parent.meta = &QWidget::staticMetaObject;
+
+  if (! root->windowTitle().isNull())
+    line(QString("parent->setWindowTitle(%1);").arg(literal(root->windowTitle())));
+
+  // generated code assumes parent is a plain widget which allows a layout
+  if (root->type() != CQXmlUtil::NoLayout) {
+    Var layout = newVar(nullptr);
+
+    layout.meta = layoutMeta(root->type());
+
+    line(QString("auto *%1 = %2;").arg(layout.name).
+           arg(newLayoutCode(root->type(), root->nameValue(CQXmlAttr::DIRECTION), "parent")));
+
+    genChildren(root, Var(), layout);
+  }
+  else
+    genChildren(root, parent, Var());
+}
+
+void
+CQXmlCodeGen::
+genChildren(CQXmlTag *tag, const Var &widget, const Var &layout)
+{
+  for (size_t i = 0; i < tag->getNumChildren(); ++i) {
+    const auto *token = tag->getChild(int(i));
+    if (! token->isTag()) continue;
+
+    auto *tag1 = dynamic_cast<CQXmlTag *>(token->getTag());
+    if (! tag1) continue;
+
+    Var widget1, layout1;
+
+    genChild(tag, tag1, widget, layout, widget1, layout1);
+
+    // same as CQXmlFactory::createChildWidgets
+    if      (tag1->isLayout()) {
+      genChildren(tag1, Var(), layout1);
+
+      auto *layoutTag = dynamic_cast<CQXmlLayoutTag *>(tag1);
+
+      if (layoutTag)
+        genEndLayout(layoutTag, layout1);
+    }
+    else if (tag1->isWidget())
+      genChildren(tag1, widget1, Var());
+  }
+}
+
+void
+CQXmlCodeGen::
+genChild(CQXmlTag *ptag, CQXmlTag *tag, const Var &widget, const Var &layout,
+         Var &widget1, Var &layout1)
+{
+  if      (dynamic_cast<CQXmlLayoutTag *>(tag))
+    layout1 = genLayout(dynamic_cast<CQXmlLayoutTag *>(tag), widget, layout);
+  else if (dynamic_cast<CQXmlLayoutItemTag *>(tag)) {
+    if (inherits(layout, QBoxLayout::staticMetaObject)) {
+      if (tag->hasNameValue(CQXmlAttr::SPACING))
+        line(QString("%1->addSpacing(%2);").arg(layout.name).
+               arg(tag->nameValue(CQXmlAttr::SPACING).toInt()));
+
+      if (tag->hasNameValue(CQXmlAttr::STRETCH))
+        line(QString("%1->addStretch(%2);").arg(layout.name).
+               arg(tag->nameValue(CQXmlAttr::STRETCH).toInt()));
+    }
+
+    layout1 = layout;
+  }
+  else if (dynamic_cast<CQXmlStyleTag *>(tag)) {
+    if (! layout.isValid())
+      return;
+
+    includes_.insert("CQStyleWidget.h");
+
+    widget1 = newVar(&QWidget::staticMetaObject);
+
+    line(QString("auto *%1 = CQStyleWidgetMgrInst->addStyleLabel(%2, %3, \"%4\");").
+           arg(widget1.name).arg(layout.name).arg(literal(tag->getText())).
+           arg(dynamic_cast<CQXmlStyleTag *>(tag)->style().c_str()));
+  }
+  else if (dynamic_cast<CQXmlQtWidgetTag *>(tag)) {
+    auto *wtag = dynamic_cast<CQXmlQtWidgetTag *>(tag);
+
+    widget1 = genWidget(wtag);
+
+    if (layout.isValid())
+      genLayoutChild(wtag, widget1, layout);
+    else
+      genWidgetChild(wtag, widget1, widget);
+  }
+  else if (tag->isExec())
+    genExec(tag, widget);
+  else if (tag->isWidget()) {
+    // item tags only act in widget parent
+    if (! layout.isValid())
+      genItem(ptag, tag, widget, widget1);
+  }
+  else
+    line(QString("// unsupported tag %1").arg(tag->getName().c_str()));
+}
+
+CQXmlCodeGen::Var
+CQXmlCodeGen::
+genLayout(CQXmlLayoutTag *tag, const Var &widget, const Var &layout)
+{
+  auto type = tag->type();
+
+  if (type == CQXmlUtil::NoLayout)
+    return Var();
+
+  Var var = newVar(nullptr);
+
+  var.meta = layoutMeta(type);
+
+  line(QString("auto *%1 = %2;").arg(var.name).
+         arg(newLayoutCode(type, tag->nameValue(CQXmlAttr::DIRECTION),
+                           widget.isValid() ? widget.name : "nullptr")));
+
+  int margin = 2, spacing = 2;
+
+  if (tag->hasNameValue(CQXmlAttr::MARGIN )) margin  = tag->nameValue(CQXmlAttr::MARGIN ).toInt();
+  if (tag->hasNameValue(CQXmlAttr::SPACING)) spacing = tag->nameValue(CQXmlAttr::SPACING).toInt();
+
+  line(QString("%1->setMargin(%2); %1->setSpacing(%3);").arg(var.name).
+         arg(margin).arg(spacing));
+
+  if (layout.isValid()) {
+    if      (inherits(layout, QBoxLayout::staticMetaObject))
+      line(QString("%1->addLayout(%2);").arg(layout.name).arg(var.name));
+    else if (inherits(layout, QGridLayout::staticMetaObject))
+      line(QString("%1->addLayout(%2, 0, 0);").arg(layout.name).arg(var.name));
+    else if (inherits(layout, QFormLayout::staticMetaObject))
+      line(QString("%1->addRow(%2, %3);").arg(layout.name).
+             arg(literal(tag->nameValue(CQXmlAttr::FORM_LABEL))).arg(var.name));
+  }
+
+  if (tag->hasNameValue(CQXmlAttr::NAME))
+    addMember(tag->nameValue(CQXmlAttr::NAME), var);
+
+  return var;
+}
+
+void
+CQXmlCodeGen::
+genEndLayout(CQXmlLayoutTag *tag, const Var &layout)
+{
+  if (! inherits(layout, QGridLayout::staticMetaObject))
+    return;
+
+  for (const auto &ipair : tag->columnStretches())
+    line(QString("%1->setColumnStretch(%2, %3);").arg(layout.name).
+           arg(ipair.first).arg(ipair.second));
+
+  for (const auto &ipair : tag->rowStretches())
+    line(QString("%1->setRowStretch(%2, %3);").arg(layout.name).
+           arg(ipair.first).arg(ipair.second));
+}
+
+// same steps as CQXmlQtWidgetTag::createWidgetI
+CQXmlCodeGen::Var
+CQXmlCodeGen::
+genWidget(CQXmlQtWidgetTag *tag)
+{
+  auto *meta = widgetMeta(tag);
+
+  Var w = newVar(meta);
+
+  addInclude(meta->className());
+
+  line(QString("auto *%1 = new %2;").arg(w.name).arg(meta->className()));
+
+  if (tag->hasNameValue(CQXmlAttr::NAME)) {
+    auto name = tag->nameValue(CQXmlAttr::NAME);
+
+    line(QString("%1->setObjectName(%2);").arg(w.name).arg(literal(name)));
+
+    addMember(name, w);
+  }
+
+  auto text = tag->getText();
+
+  if (text.length()) {
+    if      (inherits(w, QLabel::staticMetaObject) ||
+             inherits(w, QAbstractButton::staticMetaObject) ||
+             inherits(w, QLineEdit::staticMetaObject) ||
+             inherits(w, QTextEdit::staticMetaObject))
+      line(QString("%1->setText(%2);").arg(w.name).arg(literal(text)));
+    else if (inherits(w, QPlainTextEdit::staticMetaObject))
+      line(QString("%1->setPlainText(%2);").arg(w.name).arg(literal(text)));
+  }
+
+  for (const auto &nameValue : tag->nameValues()) {
+    const auto &plan = CQXmlPropertyPlan::get(meta, nameValue.id);
+    if (! plan.valid) continue;
+
+    QString propName = plan.prop.name();
+    QString value    = nameValue.value;
+
+    // typed setter (Qt naming convention) where value type is known and the class
+    // has a matching method, else set through the property (WRITE may be named
+    // differently e.g. QLCDNumber value -> display)
+    QString setter = "set" + propName.left(1).toUpper() + propName.mid(1);
+
+    auto signature =
+      QMetaObject::normalizedSignature(QString("%1(%2)").arg(setter).
+                                         arg(plan.prop.typeName()).toLatin1());
+
+    bool hasSetter = (meta->indexOfMethod(signature) >= 0);
+
+    QString code;
+
+    if (plan.isEnum) {
+      if (! plan.enumValues.contains(value))
+        continue;
+
+      code = QString("%1::%2").arg(plan.prop.enumerator().scope()).arg(value);
+    }
+    else if (plan.type == QVariant::Icon)
+      code = iconCode(value);
+    else if (plan.type == QVariant::Pixmap)
+      code = QString("QPixmap(%1)").arg(literal(value));
+    else {
+      QVariant v(value);
+
+      if (! v.convert(plan.type))
+        continue;
+
+      if      (plan.type == QVariant::Bool)
+        code = (v.toBool() ? "true" : "false");
+      else if (plan.type == QVariant::Int || plan.type == QVariant::LongLong)
+        code = QString::number(v.toLongLong());
+      else if (plan.type == QVariant::UInt || plan.type == QVariant::ULongLong)
+        code = QString::number(v.toULongLong()) + "u";
+      else if (plan.type == QVariant::Double)
+        code = QString::number(v.toDouble(), 'g', 17);
+      else if (plan.type == QVariant::String)
+        code = literal(value);
+      else {
+        // no literal form for type, convert from string at runtime
+        line(QString("%1->setProperty(\"%2\", QVariant(%3));").arg(w.name).
+               arg(propName).arg(literal(value)));
+        continue;
+      }
+    }
+
+    if (hasSetter)
+      line(QString("%1->%2(%3);").arg(w.name).arg(setter).arg(code));
+    else
+      line(QString("%1->setProperty(\"%2\", QVariant(%3));").arg(w.name).
+             arg(propName).arg(code));
+  }
+
+  if      (inherits(w, QTableWidget::staticMetaObject)) {
+    auto columnLabels = tag->nameValue(CQXmlAttr::COLUMN_LABELS).split(' ');
+    auto rowLabels    = tag->nameValue(CQXmlAttr::ROW_LABELS   ).split(' ');
+
+    line(QString("%1->setHorizontalHeaderLabels(QStringList() << %2);").arg(w.name).
+           arg(listLiteral(columnLabels)));
+    line(QString("%1->setVerticalHeaderLabels(QStringList() << %2);").arg(w.name).
+           arg(listLiteral(rowLabels)));
+  }
+  else if (inherits(w, QTreeWidget::staticMetaObject)) {
+    auto columnLabels = tag->nameValue(CQXmlAttr::COLUMN_LABELS).split(' ');
+
+    line(QString("%1->setHeaderLabels(QStringList() << %2);").arg(w.name).
+           arg(listLiteral(columnLabels)));
+  }
+
+  // size attributes (same lookups as createWidgetI)
+  if (tag->hasNameValue(CQXmlAttr::MINIMUM_SIZE)) {
+    auto sizes = tag->nameValue(CQXmlAttr::MINIMUM_SIZE).split(' ');
+
+    if (sizes.length() == 2)
+      line(QString("%1->setMinimumSize(QSize(%2, %3));").arg(w.name).
+             arg(sizes[0].toInt()).arg(sizes[1].toInt()));
+  }
+  if (tag->hasNameValue(CQXmlAttr::MINIMUM_WIDTH))
+    line(QString("%1->setMinimumWidth(%2);").arg(w.name).
+           arg(tag->nameValue(CQXmlAttr::MINIMUM_WIDTH).toInt()));
+  if (tag->hasNameValue(CQXmlAttr::MINIMUM_HEIGHT))
+    line(QString("%1->setMinimumHeight(%2);").arg(w.name).
+           arg(tag->nameValue(CQXmlAttr::MINIMUM_HEIGHT).toInt()));
+  if (tag->hasNameValue(CQXmlAttr::MAXIMUM_SIZE)) {
+    auto sizes = tag->nameValue(CQXmlAttr::MAXIMUM_SIZE).split(' ');
+
+    if (sizes.length() == 2)
+      line(QString("%1->setMaximumSize(QSize(%2, %3));").arg(w.name).
+             arg(sizes[0].toInt()).arg(sizes[1].toInt()));
+  }
+  if (tag->hasNameValue(CQXmlAttr::MAXIMUM_WIDTH))
+    line(QString("%1->setMaximumWidth(%2);").arg(w.name).
+           arg(tag->nameValue(CQXmlAttr::MAXIMUM_WIDTH).toInt()));
+  if (tag->hasNameValue(CQXmlAttr::MAXIMUM_HEIGHT))
+    line(QString("%1->setMaximumHeight(%2);").arg(w.name).
+           arg(tag->nameValue(CQXmlAttr::MAXIMUM_HEIGHT).toInt()));
+  if (tag->hasNameValue(CQXmlAttr::FIXED_SIZE)) {
+    auto sizes = tag->nameValue(CQXmlAttr::FIXED_SIZE).split(' ');
+
+    if (sizes.length() == 2)
+      line(QString("%1->setFixedSize(QSize(%2, %3));").arg(w.name).
+             arg(sizes[0].toInt()).arg(sizes[1].toInt()));
+  }
+  if (tag->hasNameValue(CQXmlAttr::FIXED_WIDTH))
+    line(QString("%1->setFixedWidth(%2);").arg(w.name).
+           arg(tag->nameValue(CQXmlAttr::FIXED_WIDTH).toInt()));
+  if (tag->hasNameValue(CQXmlAttr::FIXED_HEIGHT))
+    line(QString("%1->setFixedHeight(%2);").arg(w.name).
+           arg(tag->nameValue(CQXmlAttr::FIXED_HEIGHT).toInt()));
+
+  if (tag->hasNameValue(CQXmlAttr::MODEL))
+    line(QString("// model \"%1\" needs CQXml model factory").
+           arg(tag->nameValue(CQXmlAttr::MODEL)));
+  if (tag->hasNameValue(CQXmlAttr::ON_CLICKED))
+    line(QString("// onClicked \"%1\" needs CQXml::execSlot").
+           arg(tag->nameValue(CQXmlAttr::ON_CLICKED)));
+
+  return w;
+}
+
+// same as CQXmlQtWidgetTag::createLayoutChild
+void
+CQXmlCodeGen::
+genLayoutChild(CQXmlQtWidgetTag *tag, const Var &w, const Var &layout)
+{
+  bool allowLayout =
+    ! (inherits(w, QColorDialog::staticMetaObject) ||
+       inherits(w, QFileDialog::staticMetaObject) ||
+       inherits(w, QFontDialog::staticMetaObject) ||
+#ifdef PRINT_SUPPORT
+       inherits(w, QPrintDialog::staticMetaObject) ||
+#endif
+       inherits(w, QProgressDialog::staticMetaObject) ||
+       inherits(w, QMainWindow::staticMetaObject) ||
+       inherits(w, QMenu::staticMetaObject));
+
+  if (allowLayout) {
+    if      (inherits(layout, QBoxLayout::staticMetaObject))
+      line(QString("%1->addWidget(%2);").arg(layout.name).arg(w.name));
+    else if (inherits(layout, QGridLayout::staticMetaObject))
+      line(QString("%1->addWidget(%2, %3, %4);").arg(layout.name).arg(w.name).
+             arg(tag->nameValue(CQXmlAttr::ROW).toInt()).
+             arg(tag->nameValue(CQXmlAttr::COL).toInt()));
+    else if (inherits(layout, QFormLayout::staticMetaObject))
+      line(QString("%1->addRow(%2, %3);").arg(layout.name).
+             arg(literal(tag->nameValue(CQXmlAttr::FORM_LABEL))).arg(w.name));
+  }
+
+  if (tag->hasNameValue(CQXmlAttr::MENU_REF)) {
+    auto menu = namedVar(tag->nameValue(CQXmlAttr::MENU_REF));
+
+    if (inherits(menu, QMenu::staticMetaObject) &&
+        (inherits(w, QToolButton::staticMetaObject) || inherits(w, QPushButton::staticMetaObject)))
+      line(QString("%1->setMenu(%2);").arg(w.name).arg(menu.name));
+  }
+
+  if (inherits(w, QDialog::staticMetaObject) || inherits(w, QMainWindow::staticMetaObject))
+    line(QString("%1->show();").arg(w.name));
+}
+
+// same as CQXmlQtWidgetTag::createWidgetChild
+void
+CQXmlCodeGen::
+genWidgetChild(CQXmlQtWidgetTag *tag, const Var &w1, const Var &w)
+{
+  if (! w.isValid())
+    return;
+
+  if      (inherits(w, QTabWidget::staticMetaObject)) {
+    auto text = literal(tag->nameValue(CQXmlAttr::TAB_TEXT));
+
+    if (tag->hasNameValue(CQXmlAttr::TAB_ICON))
+      line(QString("%1->addTab(%2, %3, %4);").arg(w.name).arg(w1.name).
+             arg(iconCode(tag->nameValue(CQXmlAttr::TAB_ICON))).arg(text));
+    else
+      line(QString("%1->addTab(%2, %3);").arg(w.name).arg(w1.name).arg(text));
+  }
+  else if (inherits(w, QToolBox::staticMetaObject)) {
+    auto text = literal(tag->nameValue(CQXmlAttr::TOOL_TEXT));
+
+    if (tag->hasNameValue(CQXmlAttr::TOOL_ICON))
+      line(QString("%1->addItem(%2, %3, %4);").arg(w.name).arg(w1.name).
+             arg(iconCode(tag->nameValue(CQXmlAttr::TOOL_ICON))).arg(text));
+    else
+      line(QString("%1->addItem(%2, %3);").arg(w.name).arg(w1.name).arg(text));
+  }
+  else if (inherits(w, QStackedWidget::staticMetaObject))
+    line(QString("%1->addWidget(%2);").arg(w.name).arg(w1.name));
+  else if (inherits(w, QMenuBar::staticMetaObject) || inherits(w, QMenu::staticMetaObject)) {
+    if (inherits(w1, QMenu::staticMetaObject))
+      line(QString("%1->addMenu(%2);").arg(w.name).arg(w1.name));
+  }
+  else if (inherits(w, QMainWindow::staticMetaObject)) {
+    if      (inherits(w1, QDockWidget::staticMetaObject)) {
+      auto area = tag->nameValue(CQXmlAttr::DOCK_WIDGET_AREA);
+
+      auto areaName = QString("Qt::LeftDockWidgetArea");
+
+      if (area.length()) {
+        switch (CQXmlUtil::stringToDockWidgetArea(area)) {
+          case Qt::LeftDockWidgetArea  : areaName = "Qt::LeftDockWidgetArea"  ; break;
+          case Qt::TopDockWidgetArea   : areaName = "Qt::TopDockWidgetArea"   ; break;
+          case Qt::BottomDockWidgetArea: areaName = "Qt::BottomDockWidgetArea"; break;
+          default                      : areaName = "Qt::RightDockWidgetArea" ; break;
+        }
+      }
+
+      line(QString("%1->addDockWidget(%2, %3);").arg(w.name).arg(areaName).arg(w1.name));
+    }
+    else if (inherits(w1, QToolBar::staticMetaObject)) {
+      auto area = tag->nameValue(CQXmlAttr::TOOL_BAR_AREA);
+
+      auto areaName = QString("Qt::TopToolBarArea");
+
+      if (area.length()) {
+        switch (CQXmlUtil::stringToToolBarArea(area)) {
+          case Qt::LeftToolBarArea  : areaName = "Qt::LeftToolBarArea"  ; break;
+          case Qt::RightToolBarArea : areaName = "Qt::RightToolBarArea" ; break;
+          case Qt::BottomToolBarArea: areaName = "Qt::BottomToolBarArea"; break;
+          default                   : areaName = "Qt::TopToolBarArea"   ; break;
+        }
+      }
+
+      line(QString("%1->addToolBar(%2, %3);").arg(w.name).arg(areaName).arg(w1.name));
+    }
+    else if (inherits(w1, QMenuBar::staticMetaObject))
+      line(QString("%1->setMenuBar(%2);").arg(w.name).arg(w1.name));
+    else if (inherits(w1, QStatusBar::staticMetaObject))
+      line(QString("%1->setStatusBar(%2);").arg(w.name).arg(w1.name));
+    else
+      line(QString("%1->setCentralWidget(%2);").arg(w.name).arg(w1.name));
+  }
+  else if (inherits(w, QDockWidget::staticMetaObject) ||
+           inherits(w, QMdiSubWindow::staticMetaObject))
+    line(QString("%1->setWidget(%2);").arg(w.name).arg(w1.name));
+  else if (inherits(w, QMdiArea::staticMetaObject))
+    line(QString("%1->addSubWindow(%2);").arg(w.name).arg(w1.name));
+  else if (inherits(w, QWizard::staticMetaObject)) {
+    if (inherits(w1, QWizardPage::staticMetaObject))
+      line(QString("%1->addPage(%2);").arg(w.name).arg(w1.name));
+  }
+}
+
+// item, action and menu title tags (widget1 is the widget their children are added to)
+void
+CQXmlCodeGen::
+genItem(CQXmlTag *ptag, CQXmlTag *tag, const Var &widget, Var &widget1)
+{
+  widget1 = widget;
+
+  if (! widget.isValid())
+    return;
+
+  auto text = tag->getText();
+
+  if      (dynamic_cast<CQXmlComboItemTag *>(tag)) {
+    if (! inherits(widget, QComboBox::staticMetaObject)) return;
+
+    if (tag->hasNameValue(CQXmlAttr::ICON))
+      line(QString("%1->addItem(%2, %3);").arg(widget.name).
+             arg(iconCode(tag->nameValue(CQXmlAttr::ICON))).arg(literal(text)));
+    else
+      line(QString("%1->addItem(%2);").arg(widget.name).arg(literal(text)));
+  }
+  else if (dynamic_cast<CQXmlListItemTag *>(tag)) {
+    if (inherits(widget, QListWidget::staticMetaObject))
+      line(QString("%1->addItem(%2);").arg(widget.name).arg(literal(text)));
+  }
+  else if (dynamic_cast<CQXmlTableItemTag *>(tag)) {
+    if (inherits(widget, QTableWidget::staticMetaObject))
+      line(QString("%1->setItem(%2, %3, new QTableWidgetItem(%4));").arg(widget.name).
+             arg(tag->nameValue(CQXmlAttr::ROW).toInt()).
+             arg(tag->nameValue(CQXmlAttr::COLUMN).toInt()).arg(literal(text)));
+  }
+  else if (dynamic_cast<CQXmlTreeItemTag *>(tag)) {
+    if (! inherits(widget, QTreeWidget::staticMetaObject)) return;
+
+    auto item = QString("item%1").arg(++counts_["item"]);
+
+    auto texts = listLiteral(text.split(' '));
+
+    line(QString("auto *%1 = new QTreeWidgetItem(QStringList() << %2);").arg(item).arg(texts));
+
+    auto p = itemVars_.find(ptag);
+
+    if (p != itemVars_.end())
+      line(QString("%1->addChild(%2);").arg((*p).second).arg(item));
+    else
+      line(QString("%1->addTopLevelItem(%2);").arg(widget.name).arg(item));
+
+    itemVars_[tag] = item;
+  }
+  else if (dynamic_cast<CQXmlTabItemTag *>(tag)) {
+    if (! inherits(widget, QTabBar::staticMetaObject)) return;
+
+    if (tag->hasNameValue(CQXmlAttr::ICON))
+      line(QString("%1->addTab(%2, %3);").arg(widget.name).
+             arg(iconCode(tag->nameValue(CQXmlAttr::ICON))).arg(literal(text)));
+    else
+      line(QString("%1->addTab(%2);").arg(widget.name).arg(literal(text)));
+  }
+  else if (dynamic_cast<CQXmlMenuTitleTag *>(tag)) {
+    if (! inherits(widget, QMenuBar::staticMetaObject)) return;
+
+    widget1 = newVar(&QMenu::staticMetaObject);
+
+    line(QString("auto *%1 = %2->addMenu(%3);").arg(widget1.name).arg(widget.name).
+           arg(literal(text)));
+  }
+  else if (dynamic_cast<CQXmlActionTag *>(tag)) {
+    Var action;
+
+    if      (tag->hasNameValue(CQXmlAttr::ACTION_REF))
+      action = namedVar(tag->nameValue(CQXmlAttr::ACTION_REF));
+    else if (tag->hasNameValue(CQXmlAttr::ICON) || text.length()) {
+      action = newVar(&QAction::staticMetaObject);
+
+      line(QString("auto *%1 = new QAction(%2, nullptr);").arg(action.name).arg(literal(text)));
+
+      if (tag->hasNameValue(CQXmlAttr::ICON))
+        line(QString("%1->setIcon(%2);").arg(action.name).
+               arg(iconCode(tag->nameValue(CQXmlAttr::ICON))));
+    }
+
+    if (! action.isValid())
+      return;
+
+    includes_.insert("QAction");
+
+    if (inherits(widget, QMenu::staticMetaObject) || inherits(widget, QToolBar::staticMetaObject))
+      line(QString("%1->addAction(%2);").arg(widget.name).arg(action.name));
+
+    if (tag->hasNameValue(CQXmlAttr::NAME))
+      addMember(tag->nameValue(CQXmlAttr::NAME), action);
+  }
+  else
+    line(QString("// unsupported tag %1").arg(tag->getName().c_str()));
+}
+
+void
+CQXmlCodeGen::
+genExec(CQXmlTag *tag, const Var &widget)
+{
+  if      (dynamic_cast<CQXmlConnectTag *>(tag)) {
+    auto source = namedVar(tag->nameValue(CQXmlAttr::SOURCE));
+    auto dest   = namedVar(tag->nameValue(CQXmlAttr::DEST));
+
+    if (! source.isValid() || ! dest.isValid()) {
+      line("// connect with unknown source or dest");
+      return;
+    }
+
+    auto sourceSignal = tag->nameValue(CQXmlAttr::SOURCE_SIGNAL);
+
+    if (tag->hasNameValue(CQXmlAttr::DEST_SIGNAL))
+      line(QString("QObject::connect(%1, SIGNAL(%2), %3, SIGNAL(%4));").
+             arg(source.name).arg(sourceSignal).arg(dest.name).
+             arg(tag->nameValue(CQXmlAttr::DEST_SIGNAL)));
+    else
+      line(QString("QObject::connect(%1, SIGNAL(%2), %3, SLOT(%4));").
+             arg(source.name).arg(sourceSignal).arg(dest.name).
+             arg(tag->nameValue(CQXmlAttr::DEST_SLOT)));
+  }
+  else if (dynamic_cast<CQXmlPropertyItemTag *>(tag)) {
+    auto propertyName = tag->nameValue(CQXmlAttr::PROPERTY_NAME);
+    auto propertyVar  = namedVar(tag->nameValue(CQXmlAttr::PROPERTY_WIDGET));
+
+    if (! propertyName.size() || ! propertyVar.isValid() ||
+        ! inherits(widget, CQPropertyTree::staticMetaObject))
+      return;
+
+    addInclude("CQPropertyTree");
+
+    line(QString("%1->addProperty(%2, %3, %4);").arg(widget.name).
+           arg(literal(tag->nameValue(CQXmlAttr::PROPERTY_PATH))).arg(propertyVar.name).
+           arg(literal(propertyName)));
+  }
+  else
+    line(QString("// unsupported tag %1").arg(tag->getName().c_str()));
+}
+
+CQXmlCodeGen::Var
+CQXmlCodeGen::
+newVar(const QMetaObject *meta)
+{
+  // variable name from class name (QPushButton -> pushButton1)
+  QString base = (meta ? meta->className() : "layout");
+
+  if (base.length() > 1 && base[0] == 'Q' && base[1].isUpper())
+    base = base.mid(1);
+
+  base = base.left(1).toLower() + base.mid(1);
+
+  Var var;
+
+  var.name = QString("%1%2").arg(base).arg(++counts_[base]);
+  var.meta = meta;
+
+  return var;
+}
+
+void
+CQXmlCodeGen::
+addMember(const QString &name, const Var &var)
+{
+  // member name must be identifier
+  QString id;
+
+  for (const auto &c : name)
+    id += (c.isLetterOrNumber() || c == '_' ? c : QChar('_'));
+
+  if (id.isEmpty() || id[0].isDigit())
+    id = "_" + id;
+
+  for (const auto &member : members_) {
+    if (member.name == id) {
+      id += QString("_%1").arg(members_.size());
+      break;
+    }
+  }
+
+  Member member;
+
+  member.name      = id;
+  member.className = var.meta->className();
+
+  members_.push_back(member);
+
+  line(QString("%1_ = %2;").arg(id).arg(var.name));
+
+  namedVars_[name] = var;
+}
+
+CQXmlCodeGen::Var
+CQXmlCodeGen::
+namedVar(const QString &name) const
+{
+  auto p = namedVars_.find(name);
+
+  if (p == namedVars_.end())
+    return Var();
+
+  return (*p).second;
+}
+
+// meta object of class created by widget factory. Uses factory's class if known,
+// else creates (one) prototype widget
+const QMetaObject *
+CQXmlCodeGen::
+widgetMeta(CQXmlQtWidgetTag *tag)
+{
+  auto *factory = tag->factory();
+
+  // factory removed since parse
+  if (! factory)
+    return &QWidget::staticMetaObject;
+
+  auto p = metas_.find(factory);
+
+  if (p != metas_.end())
+    return (*p).second;
+
+  auto *meta = factory->metaObject();
+
+  if (! meta) {
+    auto *w = factory->createWidget(tag->options());
+
+    meta = w->metaObject();
+
+    delete w;
+  }
+
+  metas_[factory] = meta;
+
+  return meta;
+}
+
+bool
+CQXmlCodeGen::
+inherits(const Var &var, const QMetaObject &meta)
+{
+  for (auto *meta1 = var.meta; meta1; meta1 = meta1->superClass())
+    if (meta1 == &meta)
+      return true;
+
+  return false;
+}
+
+QString
+CQXmlCodeGen::
+layoutClass(CQXmlUtil::LayoutType type)
+{
+  switch (type) {
+    case CQXmlUtil::HBoxLayout: return "QHBoxLayout";
+    case CQXmlUtil::VBoxLayout: return "QVBoxLayout";
+    case CQXmlUtil::BoxLayout : return "QBoxLayout";
+    case CQXmlUtil::GridLayout: return "QGridLayout";
+    case CQXmlUtil::FormLayout: return "QFormLayout";
+    default                   : return "";
+  }
+}
+
+const QMetaObject *
+CQXmlCodeGen::
+layoutMeta(CQXmlUtil::LayoutType type)
+{
+  if      (type == CQXmlUtil::GridLayout) return &QGridLayout::staticMetaObject;
+  else if (type == CQXmlUtil::FormLayout) return &QFormLayout::staticMetaObject;
+  else                                    return &QBoxLayout ::staticMetaObject;
+}
+
+QString
+CQXmlCodeGen::
+newLayoutCode(CQXmlUtil::LayoutType type, const QString &dir, const QString &parent)
+{
+  auto lclass = layoutClass(type);
+
+  addInclude(lclass);
+
+  if (type != CQXmlUtil::BoxLayout)
+    return QString("new %1(%2)").arg(lclass).arg(parent);
+
+  QString dirName;
+
+  switch (CQXmlUtil::stringToBoxLayoutDirection(dir)) {
+    case QBoxLayout::RightToLeft: dirName = "QBoxLayout::RightToLeft"; break;
+    case QBoxLayout::TopToBottom: dirName = "QBoxLayout::TopToBottom"; break;
+    case QBoxLayout::BottomToTop: dirName = "QBoxLayout::BottomToTop"; break;
+    default                     : dirName = "QBoxLayout::LeftToRight"; break;
+  }
+
+  return QString("new QBoxLayout(%1, %2)").arg(dirName).arg(parent);
+}
+
+QString
+CQXmlCodeGen::
+literal(const QString &str)
+{
+  QString lit = "\"";
+
+  bool ascii = true;
+
+  // non-ascii characters as escaped utf-8 bytes (always three octal digits)
+  for (auto c : str.toUtf8()) {
+    if      (c == '"' ) lit += "\\\"";
+    else if (c == '\\') lit += "\\\\";
+    else if (c == '\n') lit += "\\n";
+    else if (c == '\t') lit += "\\t";
+    else if (uchar(c) >= 0x80) {
+      lit += QString("\\%1").arg(uint(uchar(c)), 3, 8, QChar('0'));
+
+      ascii = false;
+    }
+    else
+      lit += QChar(c);
+  }
+
+  lit += "\"";
+
+  return (ascii ? lit : QString("QString::fromUtf8(%1)").arg(lit));
+}
+
+QString
+CQXmlCodeGen::
+listLiteral(const QStringList &strs)
+{
+  QStringList lits;
+
+  for (const auto &str : strs)
+    lits << literal(str);
+
+  return lits.join(" << ");
+}
+
+QString
+CQXmlCodeGen::
+iconCode(const QString &filename) const
+{
+  return QString("QIcon(QPixmap(%1))").arg(literal(filename));
+}
+
+void
+CQXmlCodeGen::
+addInclude(const QString &className)
+{
+  if (className.isEmpty())
+    return;
+
+  // Qt classes have header of same name, others use <name>.h
+  if (className.length() > 1 && className[0] == 'Q' && className[1].isUpper())
+    includes_.insert(className);
+  else
+    includes_.insert(className + ".h");
+}
+
+bool
+CQXmlCodeGen::
+write(const QString &headerFilename, const QString &sourceFilename) const
+{
+  QFile hfile(headerFilename);
+  QFile sfile(sourceFilename);
+
+  if (! hfile.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+      ! sfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  auto guard = className_ + "_H";
+
+  QString header;
+
+  header += QString("// generated from %1 by CQXmlGen (do not edit)\n\n").arg(filename_);
+  header += QString("#ifndef %1\n#define %1\n\n").arg(guard);
+
+  std::set<QString> classNames;
+
+  classNames.insert("QWidget");
+
+  for (const auto &member : members_)
+    classNames.insert(member.className);
+
+  for (const auto &name : classNames)
+    header += QString("class %1;\n").arg(name);
+
+  header += QString("\nclass %1 {\n public:\n").arg(className_);
+  header += "  void setupUi(QWidget *parent);\n";
+
+  if (! members_.empty())
+    header += "\n";
+
+  for (const auto &member : members_)
+    header += QString("  %1 *%2() const { return %2_; }\n").
+                arg(member.className).arg(member.name);
+
+  if (! members_.empty()) {
+    header += "\n private:\n";
+
+    for (const auto &member : members_)
+      header += QString("  %1 *%2_ { nullptr };\n").arg(member.className).arg(member.name);
+  }
+
+  header += QString("};\n\n#endif\n");
+
+  QString source;
+
+  source += QString("// generated from %1 by CQXmlGen (do not edit)\n\n").arg(filename_);
+
+  QFileInfo hfi(headerFilename);
+
+  source += QString("#include <%1>\n\n").arg(hfi.fileName());
+
+  for (const auto &include : includes_)
+    source += QString("#include <%1>\n").arg(include);
+
+  source += "#include <QIcon>\n#include <QPixmap>\n";
 
-  CQXmlAddTagFactoryT(this, "connect", CQXmlConnectTag);
+  source += QString("\nvoid\n%1::\nsetupUi(QWidget *parent)\n{\n").arg(className_);
 
-  addTagFactory("QHBoxLayout", new CQXmlLayoutTagFactory(CQXmlUtil::HBoxLayout));
-  addTagFactory("QVBoxLayout", new CQXmlLayoutTagFactory(CQXmlUtil::VBoxLayout));
-  addTagFactory("QBoxLayout" , new CQXmlLayoutTagFactory(CQXmlUtil::BoxLayout ));
-  addTagFactory("QGridLayout", new CQXmlLayoutTagFactory(CQXmlUtil::GridLayout));
-  addTagFactory("QFormLayout", new CQXmlLayoutTagFactory(CQXmlUtil::FormLayout));
+  for (const auto &str : body_)
+    source += str + "\n";
 
-  addTagFactory("h1", new CQXmlStyleTagFactory("h1"));
-  addTagFactory("h2", new CQXmlStyleTagFactory("h2"));
-  addTagFactory("h3", new CQXmlStyleTagFactory("h3"));
-  addTagFactory("h4", new CQXmlStyleTagFactory("h4"));
-  addTagFactory("p" , new CQXmlStyleTagFactory("p" ));
-}
+  source += "}\n";
 
-CQXml::
-~CQXml()
-{
-  delete xml_;
+  return (hfile.write(header.toUtf8()) >= 0 && sfile.write(source.toUtf8()) >= 0);
 }
 
-//-----
-
 bool
 CQXml::
-isWidgetFactory(const QString &name) const
+generateCode(const std::string &filename, const std::string &className,
+             const std::string &headerFilename, const std::string &sourceFilename)
 {
-  return (widgetFactories_.find(name) != widgetFactories_.end());
+  CQXmlTemplate tmpl(this);
+
+  tmpl.factory->setDeferAllowed(false);
+
+  CXMLTag *tag;
+
+  if (! parse(tmpl.xml, filename, /*isFile*/true, &tag) || ! tmpl.factory->root())
+    return false;
+
+  CQXmlCodeGen gen(className.c_str(), QFileInfo(filename.c_str()).fileName());
+
+  gen.generate(tmpl.factory->root());
+
+  return gen.write(headerFilename.c_str(), sourceFilename.c_str());
 }
 
+//------
+
 void
-CQXml::
-addWidgetFactory(const QString &name, CQXmlWidgetFactory *factory)
+CQXmlStats::
+add(Phase phase, const QString &name, qint64 nsecs)
 {
-  if (isWidgetFactory(name))
-    removeWidgetFactory(name);
+  QMutexLocker locker(&mutex_);
+
+  auto &entry = entries_[Key(int(phase), name)];
 
-  widgetFactories_[name] = factory;
+  if (! entry.count) {
+    entry.phase = phase;
+    entry.name  = name;
+  }
+
+  ++entry.count;
+
+  entry.nsecs += nsecs;
 }
 
 void
-CQXml::
-removeWidgetFactory(const QString &name)
+CQXmlStats::
+clear()
 {
-  auto p = widgetFactories_.find(name);
-  assert(p != widgetFactories_.end());
+  QMutexLocker locker(&mutex_);
 
-  widgetFactories_.erase(p);
+  entries_.clear();
 }
 
-CQXmlWidgetFactory *
-CQXml::
-getWidgetFactory(const QString &name) const
+CQXmlStats::Entries
+CQXmlStats::
+entries() const
 {
-  auto p = widgetFactories_.find(name);
-  assert(p != widgetFactories_.end());
+  QMutexLocker locker(&mutex_);
 
-  return (*p).second;
-}
+  Entries entries;
 
-//------
+  for (const auto &pe : entries_)
+    entries.push_back(pe.second);
 
-bool
-CQXml::
-isTagFactory(const QString &name) const
-{
-  return (tagFactories_.find(name) != tagFactories_.end());
+  return entries;
 }
 
-void
-CQXml::
-addTagFactory(const QString &name, CQXmlTagFactory *factory)
+CQXmlStats::Entry
+CQXmlStats::
+phaseTotal(Phase phase) const
 {
-  if (isTagFactory(name))
-    removeTagFactory(name);
+  QMutexLocker locker(&mutex_);
+
+  Entry total;
+
+  total.phase = phase;
 
-  tagFactories_[name] = factory;
+  for (const auto &pe : entries_) {
+    if (pe.second.phase != phase) continue;
+
+    total.count += pe.second.count;
+    total.nsecs += pe.second.nsecs;
+  }
+
+  return total;
 }
 
-void
-CQXml::
-removeTagFactory(const QString &name)
+QString
+CQXmlStats::
+phaseName(Phase phase)
 {
-  auto p = tagFactories_.find(name);
-  assert(p != tagFactories_.end());
-
-  tagFactories_.erase(p);
+  switch (phase) {
+    case Phase::PARSE      : return "parse";
+    case Phase::CREATE_TAG : return "createTag";
+    case Phase::CONSTRUCT  : return "construct";
+    case Phase::PROPERTIES : return "properties";
+    case Phase::SIZES      : return "sizes";
+    case Phase::ICON_DECODE: return "iconDecode";
+    case Phase::END_LAYOUT : return "endLayout";
+    default                : return "";
+  }
 }
 
-CQXmlTagFactory *
-CQXml::
-getTagFactory(const QString &name) const
+QString
+CQXmlStats::
+toJson() const
 {
-  auto p = tagFactories_.find(name);
-  assert(p != tagFactories_.end());
+  static Phase phases[] = {
+    Phase::PARSE, Phase::CREATE_TAG, Phase::CONSTRUCT, Phase::PROPERTIES, Phase::SIZES,
+    Phase::ICON_DECODE, Phase::END_LAYOUT
+  };
 
-  return (*p).second;
-}
+  QJsonObject totals;
 
-//------
+  for (const auto &phase : phases) {
+    auto total = phaseTotal(phase);
 
-bool
-CQXml::
-createWidgetsFromString(QWidget *parent, const std::string &str)
+    QJsonObject obj;
+
+    obj["count"] = total.count;
+    obj["nsecs"] = total.nsecs;
+
+    totals[phaseName(phase)] = obj;
+  }
+
+  QJsonArray array;
+
+  for (const auto &entry : entries()) {
+    QJsonObject obj;
+
+    obj["phase"] = phaseName(entry.phase);
+    obj["name" ] = entry.name;
+    obj["count"] = entry.count;
+    obj["nsecs"] = entry.nsecs;
+
+    array.append(obj);
+  }
+
+  QJsonObject root;
+
+  root["phases" ] = totals;
+  root["entries"] = array;
+
+  return QString::fromUtf8(QJsonDocument(root).toJson());
+}
+
+QString
+CQXmlStats::
+toCsv() const
 {
-  parent_ = parent;
+  QString str = "phase,name,count,nsecs\n";
 
-  CXMLTag *tag;
+  for (const auto &entry : entries()) {
+    auto name = entry.name;
 
-  if (! xml_->readString(str, &tag))
-    return false;
+    if (name.contains(',') || name.contains('"'))
+      name = "\"" + name.replace("\"", "\"\"") + "\"";
 
-  factory_->createWidgets(parent);
+    str += QString("%1,%2,%3,%4\n").arg(phaseName(entry.phase)).arg(name).
+             arg(entry.count).arg(entry.nsecs);
+  }
 
-  return true;
+  return str;
 }
 
 bool
-CQXml::
-createWidgetsFromFile(QWidget *parent, const std::string &filename)
+CQXmlStats::
+writeJson(const QString &filename) const
 {
-  parent_ = parent;
-
-  CXMLTag *tag;
+  QFile file(filename);
 
-  if (! xml_->read(filename, &tag))
+  if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate))
     return false;
 
-  factory_->createWidgets(parent);
-
-  return true;
+  return (file.write(toJson().toUtf8()) >= 0);
 }
 
-void
-CQXml::
-addLayout(const QString &name, QLayout *l)
+bool
+CQXmlStats::
+writeCsv(const QString &filename) const
 {
-  layouts_[name] = l;
+  QFile file(filename);
+
+  if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  return (file.write(toCsv().toUtf8()) >= 0);
 }
 
-QLayout *
-CQXml::
-getLayout(const QString &name) const
+//------
+
+struct CQXmlIconCache::Pending {
+  QFutureWatcher<QImage>* watcher { nullptr };
+  Patches                 patches;
+};
+
+struct CQXmlIconCache::PendingMap : public QHash<QString, CQXmlIconCache::Pending> {
+};
+
+CQXmlIconCache::
+CQXmlIconCache(qint64 maxBytes) :
+ maxBytes_(maxBytes)
 {
-  auto p = layouts_.find(name);
+  pending_ = new PendingMap;
+}
 
-  if (p == layouts_.end())
-    return nullptr;
+CQXmlIconCache::
+~CQXmlIconCache()
+{
+  for (auto &pending : *pending_)
+    pending.watcher->waitForFinished();
 
-  return (*p).second;
+  delete pending_;
 }
 
 void
-CQXml::
-addWidget(const QString &name, QWidget *w)
+CQXmlIconCache::
+setMaxBytes(qint64 n)
 {
-  widgets_[name] = w;
+  maxBytes_ = n;
+
+  evict();
 }
 
-QWidget *
-CQXml::
-getWidget(const QString &name) const
+void
+CQXmlIconCache::
+prefetch(const QString &filename)
 {
-  auto p = widgets_.find(name);
+  if (! isAsyncDecode())
+    return;
 
-  if (p == widgets_.end())
-    return nullptr;
+  if (entries_.contains(filename) || pending_->contains(filename))
+    return;
 
-  return (*p).second;
+  auto *watcher = new QFutureWatcher<QImage>(this);
+
+  watcher->setProperty("filename", filename);
+
+  connect(watcher, SIGNAL(finished()), this, SLOT(decodedSlot()));
+
+  Pending pending;
+
+  pending.watcher = watcher;
+
+  (*pending_)[filename] = pending;
+
+  auto *stats = stats_;
+
+  watcher->setFuture(QtConcurrent::run([filename, stats]() {
+    if (! stats)
+      return QImage(filename);
+
+    QElapsedTimer timer;
+
+    timer.start();
+
+    QImage image(filename);
+
+    stats->add(CQXmlStats::Phase::ICON_DECODE, filename, timer.nsecsElapsed());
+
+    return image;
+  }));
 }
 
 void
-CQXml::
-addAction(const QString &name, QAction *w)
+CQXmlIconCache::
+addImage(const QString &filename, const QImage &image)
 {
-  actions_[name] = w;
+  if (entries_.contains(filename) || pending_->contains(filename))
+    return;
+
+  (void) addPixmap(filename, QPixmap::fromImage(image), /*used*/false);
 }
 
-QAction *
-CQXml::
-getAction(const QString &name) const
+QPixmap
+CQXmlIconCache::
+pixmap(const QString &filename)
 {
-  auto p = actions_.find(name);
+  auto p = entries_.find(filename);
 
-  if (p == actions_.end())
-    return nullptr;
+  if (p != entries_.end()) {
+    // first use of prefetched or added image is a miss
+    if ((*p).used)
+      ++hits_;
+    else
+      ++misses_;
 
-  return (*p).second;
+    (*p).used = true;
+
+    // move to most recently used
+    lru_.splice(lru_.begin(), lru_, (*p).pos);
+
+    return (*p).pixmap;
+  }
+
+  ++misses_;
+
+  // wait for background decode
+  auto pp = pending_->find(filename);
+
+  if (pp != pending_->end()) {
+    auto pending = pp.value();
+
+    pending_->erase(pp);
+
+    return finishPending(filename, pending, /*used*/true);
+  }
+
+  if (! stats_)
+    return addPixmap(filename, QPixmap(filename), /*used*/true);
+
+  QElapsedTimer timer;
+
+  timer.start();
+
+  QPixmap pixmap(filename);
+
+  stats_->add(CQXmlStats::Phase::ICON_DECODE, filename, timer.nsecsElapsed());
+
+  return addPixmap(filename, pixmap, /*used*/true);
 }
 
-void
-CQXml::
-onSlot()
+QPixmap
+CQXmlIconCache::
+pixmap(const QString &filename, QObject *target, const PixmapSetter &setter)
 {
-  auto value = sender()->property("onValue").toString();
+  if (isPlaceholders()) {
+    auto pp = pending_->find(filename);
 
-  execSlot(value);
+    if (pp != pending_->end()) {
+      ++misses_;
+
+      Patch patch;
+
+      patch.target = target;
+      patch.setter = setter;
+
+      (*pp).patches.push_back(patch);
+
+      return placeholder_;
+    }
+  }
+
+  return pixmap(filename);
 }
 
 void
-CQXml::
-execSlot(const QString &str)
+CQXmlIconCache::
+clear()
 {
-  std::cout << str.toStdString() << "\n";
-}
+  entries_.clear();
+  lru_    .clear();
 
-//-------
+  numBytes_ = 0;
+}
 
-CXMLTag *
-CQXmlFactory::
-createTag(const CXML *xml, CXMLTag *parent, const std::string &name, CXMLTag::OptionArray &options)
+void
+CQXmlIconCache::
+decodedSlot()
 {
-  using NameValues = std::map<QString, QString>;
+  auto *watcher = static_cast<QFutureWatcher<QImage> *>(sender());
 
-  NameValues nameValues;
+  auto filename = watcher->property("filename").toString();
 
-  for (auto option : options) {
-    const std::string &name  = option->getName();
-    const std::string &value = option->getValue();
+  // already waited for by pixmap()
+  auto pp = pending_->find(filename);
 
-    nameValues[name.c_str()] = value.c_str();
-  }
+  if (pp == pending_->end() || pp.value().watcher != watcher)
+    return;
 
-  //---
+  auto pending = pp.value();
 
-  CQXmlTag *tag = nullptr;
+  pending_->erase(pp);
 
-  if      (name == "qxml")
-    tag = new CQXmlRootTag(parent, xml_, name, options);
-  else if (xml_->isTagFactory(name.c_str()))
-    tag = xml_->getTagFactory(name.c_str())->createTag(xml, parent, name, options);
-  else if (xml_->isWidgetFactory(name.c_str()))
-    tag = new CQXmlQtWidgetTag(xml, parent, name, options);
-  else {
-    std::cerr << "Invalid tag name " << name << std::endl;
-    return CXMLFactory::createTag(xml, parent, name, options);
+  // used if placeholder was patched
+  (void) finishPending(filename, pending, ! pending.patches.empty());
+}
+
+QPixmap
+CQXmlIconCache::
+finishPending(const QString &filename, const Pending &pending, bool used)
+{
+  // pixmap must be created in gui thread
+  auto pixmap = addPixmap(filename, QPixmap::fromImage(pending.watcher->result()), used);
+
+  for (const auto &patch : pending.patches) {
+    if (patch.target)
+      patch.setter(pixmap);
   }
 
-  if (tag)
-    tag->handleOptions(options);
+  pending.watcher->deleteLater();
 
-  return tag;
+  return pixmap;
 }
 
-void
-CQXmlFactory::
-createWidgets(QWidget *parent)
+QPixmap
+CQXmlIconCache::
+addPixmap(const QString &filename, const QPixmap &pixmap, bool used)
 {
-  QLayout *layout = nullptr;
+  // failed load is not cached (file may be created later)
+  if (pixmap.isNull())
+    return pixmap;
 
-  if (CQXmlUtil::allowLayout(parent))
-    layout = root_->createRootLayout(parent);
+  qint64 bytes = qint64(pixmap.width())*pixmap.height()*pixmap.depth()/8;
 
-  if (layout)
-    createWidgets(root_, layout);
-  else
-    createWidgets(root_, parent);
+  if (bytes > maxBytes_)
+    return pixmap;
+
+  lru_.push_front(filename);
+
+  Entry entry;
+
+  entry.pixmap = pixmap;
+  entry.bytes  = bytes;
+  entry.used   = used;
+  entry.pos    = lru_.begin();
+
+  entries_[filename] = entry;
+
+  numBytes_ += bytes;
+
+  evict();
+
+  return pixmap;
 }
 
 void
-CQXmlFactory::
-createWidgets(CXMLTag *tag, QLayout *layout)
+CQXmlIconCache::
+evict()
 {
-  auto *ptag = dynamic_cast<CQXmlTag *>(tag);
-
-  for (size_t i = 0; i < tag->getNumChildren(); ++i) {
-    const auto *token = tag->getChild(int(i));
+  while (numBytes_ > maxBytes_ && ! lru_.empty()) {
+    auto p = entries_.find(lru_.back());
 
-    if (token->isTag()) {
-      auto *tag1 = dynamic_cast<CQXmlTag *>(token->getTag());
-      if (! tag1) continue;
+    numBytes_ -= (*p).bytes;
 
-      if      (tag1->isLayout()) {
-        auto *layout1 = tag1->createLayout(nullptr, layout, ptag);
+    entries_.erase(p);
 
-        createWidgets(tag1, layout1);
-
-        tag1->endLayout();
-      }
-      else if (tag1->isWidget()) {
-        auto *widget = tag1->createLayoutChild(layout, ptag);
+    lru_.pop_back();
 
-        createWidgets(tag1, widget);
-      }
-      else if (tag1->isExec()) {
-        (void) tag1->exec(nullptr, layout);
-      }
-    }
+    ++evictions_;
   }
 }
 
-void
-CQXmlFactory::
-createWidgets(CXMLTag *tag, QWidget *widget)
+//------
+
+qint64
+CQXmlTag::
+memoryBytes()
 {
-  auto *ptag = dynamic_cast<CQXmlTag *>(tag);
+  qint64 bytes = qint64(allocSize());
 
-  for (size_t i = 0; i < tag->getNumChildren(); ++i) {
-    const auto *token = tag->getChild(int(i));
+  bytes += qint64(getName().capacity());
 
-    if (token->isTag()) {
-      auto *tag1 = dynamic_cast<CQXmlTag *>(token->getTag());
-      if (! tag1) continue;
+  // option strings kept by CXMLTag
+  for (const auto *option : getOptions())
+    bytes += qint64(sizeof(*option) + option->getName ().capacity() +
+                                      option->getValue().capacity());
 
-      if      (tag1->isLayout()) {
-        auto *layout1 = tag1->createLayout(widget, nullptr, ptag);
+  bytes += qint64(nameValues_.capacity()*sizeof(NameValue));
 
-        if (qobject_cast<QGroupBox *>(widget))
-          qobject_cast<QGroupBox *>(widget)->setLayout(layout1);
+  for (const auto &nameValue : nameValues_)
+    bytes += nameValue.value.size()*qint64(sizeof(QChar));
 
-        createWidgets(tag1, layout1);
+  bytes += text_.size()*qint64(sizeof(QChar));
 
-        tag1->endLayout();
-      }
-      else if (tag1->isWidget()) {
-        auto *widget1 = tag1->createWidgetChild(widget, ptag);
+  for (size_t i = 0; i < getNumChildren(); ++i) {
+    const auto *token = getChild(int(i));
 
-        createWidgets(tag1, widget1);
-      }
-      else if (tag1->isExec()) {
-        (void) tag1->exec(widget, nullptr);
-      }
-    }
+    auto *tag = (token->isTag() ? dynamic_cast<CQXmlTag *>(token->getTag()) : nullptr);
+
+    if (tag)
+      bytes += tag->memoryBytes();
+    else
+      bytes += qint64(4*sizeof(void *)); // text token
   }
+
+  return bytes;
 }
 
-//------
+void
+CQXmlTag::
+addNames(QStringList &names)
+{
+  if (hasNameValue(CQXmlAttr::NAME))
+    names << nameValue(CQXmlAttr::NAME);
+
+  for (size_t i = 0; i < getNumChildren(); ++i) {
+    const auto *token = getChild(int(i));
+
+    auto *tag = (token->isTag() ? dynamic_cast<CQXmlTag *>(token->getTag()) : nullptr);
 
-CQXml *
+    if (tag)
+      tag->addNames(names);
+  }
+}
+
+void
 CQXmlTag::
-getXml() const
+prefetchPixmap(const QString &filename) const
 {
-  auto *parent = dynamic_cast<CQXmlTag *>(getParent());
+  auto *xml = getXml();
+  if (! xml) return;
 
-  while (parent && ! parent->isRoot())
-    parent = dynamic_cast<CQXmlTag *>(parent->getParent());
+  // tags parsed on worker thread queue decode on icon cache thread
+  auto *cache = xml->iconCache();
 
-  if (parent)
-    return dynamic_cast<CQXmlRootTag *>(parent)->getXml();
+  if (QThread::currentThread() != cache->thread())
+    QMetaObject::invokeMethod(cache, "prefetch", Qt::QueuedConnection, Q_ARG(QString, filename));
+  else
+    cache->prefetch(filename);
+}
+
+QPixmap
+CQXmlTag::
+loadPixmap(const QString &filename) const
+{
+  return getXml()->iconCache()->pixmap(filename);
+}
 
-  return nullptr;
+QPixmap
+CQXmlTag::
+loadPixmap(const QString &filename, QObject *target,
+           const CQXmlIconCache::PixmapSetter &setter) const
+{
+  return getXml()->iconCache()->pixmap(filename, target, setter);
 }
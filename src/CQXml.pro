@@ -4,7 +4,7 @@ TARGET = CQXml
 
 DEPENDPATH += .
 
-QT += widgets printsupport webkitwidgets
+QT += widgets concurrent printsupport webkitwidgets
 
 CONFIG += staticlib
 
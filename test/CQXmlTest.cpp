@@ -6,6 +6,9 @@
 #include <CFile.h>
 #include <QVBoxLayout>
 #include <QLineEdit>
+#include <QShortcut>
+#include <QFile>
+#include <QDir>
 #include <iostream>
 
 static const char *xmlStr =
@@ -37,12 +40,29 @@ main(int argc, char **argv)
 
   CQXmlTest *test = new CQXmlTest;
 
-  if (argc > 1) {
-    for (int i = 1; i < argc; ++i) {
-      if (! test->loadFile(argv[i]))
-        std::cerr << std::string("Failed to load '") + argv[i] + "'\n";
-    }
+  std::vector<std::string> filenames;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+
+    // -stream : build widgets while reading (no parse tree)
+    // -watch  : reload file when it changes
+    // -reload <file> : load copy of first file, F5 switches copy between first file
+    //                  and <file> and reloads it (see test/data/reload/README)
+    if      (arg == "-stream")
+      test->setStreaming(true);
+    else if (arg == "-watch")
+      test->setWatchFile(true);
+    else if (arg == "-reload" && i < argc - 1)
+      test->setReloadFile(argv[++i]);
+    else
+      filenames.push_back(arg);
   }
+
+  if      (filenames.size() == 1 && test->isReload())
+    (void) test->loadReload(filenames[0]);
+  else if (! filenames.empty())
+    (void) test->loadFiles(filenames);
   else
     test->loadStr(xmlStr);
 
@@ -61,6 +81,20 @@ CQXmlTest()
   xml_ = new CQXml;
 }
 
+void
+CQXmlTest::
+setStreaming(bool b)
+{
+  xml_->setStreaming(b);
+}
+
+void
+CQXmlTest::
+setWatchFile(bool b)
+{
+  xml_->setWatchFile(b);
+}
+
 bool
 CQXmlTest::
 loadFile(const char *filename)
@@ -71,6 +105,46 @@ loadFile(const char *filename)
   return xml_->createWidgetsFromFile(this, filename);
 }
 
+// parse files in parallel and add their widgets in argument order
+bool
+CQXmlTest::
+loadFiles(const std::vector<std::string> &filenames)
+{
+  // streamed files have no parse tree to build in parallel
+  if (xml_->isStreaming()) {
+    bool rc = true;
+
+    for (const auto &filename : filenames) {
+      if (! loadFile(filename.c_str())) {
+        std::cerr << "Failed to load '" + filename + "'\n";
+        rc = false;
+      }
+    }
+
+    return rc;
+  }
+
+  CQXml::FileLoads loads;
+
+  for (const auto &filename : filenames) {
+    CQXml::FileLoad load;
+
+    load.parent   = this;
+    load.filename = filename;
+
+    loads.push_back(load);
+  }
+
+  bool rc = xml_->createWidgetsFromFiles(loads);
+
+  for (const auto &load : loads) {
+    if (! load.rc)
+      std::cerr << "Failed to load '" + load.filename + "'\n";
+  }
+
+  return rc;
+}
+
 void
 CQXmlTest::
 loadStr(const char *str)
@@ -87,6 +161,57 @@ loadStr(const char *str)
   layout()->addWidget(new CQStyleDivider("p", CQStyleDivider::LineType));
 }
 
+// load copy of file which F5 switches between file and reload file contents
+bool
+CQXmlTest::
+loadReload(const std::string &filename)
+{
+  reloadFiles_ = { filename, reloadFile_ };
+  reloadInd_   = 0;
+
+  copyFile_ = QDir::temp().filePath("CQXmlTestReload.xml").toStdString();
+
+  if (! copyReloadFile())
+    return false;
+
+  auto *shortcut = new QShortcut(QKeySequence(Qt::Key_F5), this);
+
+  connect(shortcut, SIGNAL(activated()), this, SLOT(reloadSlot()));
+
+  return loadFile(copyFile_.c_str());
+}
+
+bool
+CQXmlTest::
+copyReloadFile()
+{
+  const auto &filename = reloadFiles_[size_t(reloadInd_)];
+
+  (void) QFile::remove(copyFile_.c_str());
+
+  if (! QFile::copy(filename.c_str(), copyFile_.c_str())) {
+    std::cerr << "Failed to copy '" + filename + "'\n";
+    return false;
+  }
+
+  setWindowTitle(filename.c_str());
+
+  return true;
+}
+
+void
+CQXmlTest::
+reloadSlot()
+{
+  reloadInd_ = 1 - reloadInd_;
+
+  if (! copyReloadFile())
+    return;
+
+  if (! xml_->reload())
+    std::cerr << "Failed to reload '" + reloadFiles_[size_t(reloadInd_)] + "'\n";
+}
+
 void
 CQXmlTest::
 addControl()
@@ -1,4 +1,6 @@
 #include <QDialog>
+#include <vector>
+#include <string>
 
 class CQXml;
 
@@ -8,11 +10,31 @@ class CQXmlTest : public QDialog {
  public:
   CQXmlTest();
 
+  void setStreaming(bool b);
+
+  void setWatchFile(bool b);
+
+  bool isReload() const { return ! reloadFile_.empty(); }
+  void setReloadFile(const std::string &filename) { reloadFile_ = filename; }
+
   bool loadFile(const char *filename);
+  bool loadFiles(const std::vector<std::string> &filenames);
   void loadStr(const char *str);
 
+  bool loadReload(const std::string &filename);
+
   void addControl();
 
+ private Q_SLOTS:
+  void reloadSlot();
+
+ private:
+  bool copyReloadFile();
+
  private:
-  CQXml *xml_;
+  CQXml*                   xml_ { nullptr };
+  std::string              reloadFile_;
+  std::vector<std::string> reloadFiles_;
+  int                      reloadInd_ { 0 };
+  std::string              copyFile_;
 };
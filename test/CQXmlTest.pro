@@ -4,7 +4,7 @@ TARGET = CQXmlTest
 
 DEPENDPATH += .
 
-QT += widgets printsupport webkitwidgets
+QT += widgets concurrent printsupport webkitwidgets
 
 #CONFIG += debug
 